@@ -1,5 +1,6 @@
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
+#include <juce_audio_formats/juce_audio_formats.h>
 
 DreamverbEditor::DreamverbEditor(DreamverbProcessor& p)
     : AudioProcessorEditor(&p), proc(p)
@@ -51,18 +52,40 @@ DreamverbEditor::DreamverbEditor(DreamverbProcessor& p)
         m.addItem(3, "100%", true, std::abs(scale - 1.00f) < 0.01f);
         m.addItem(4, "125%", true, std::abs(scale - 1.25f) < 0.01f);
         m.addItem(5, "150%", true, std::abs(scale - 1.50f) < 0.01f);
+        const auto ir = proc.getImpulseResponse();
+        m.addSectionHeader("Impulse Response" + (ir.existsAsFile() ? " - " + ir.getFileName() : juce::String()));
+        m.addItem(6, "Load...");
+        m.addItem(7, "Clear", ir != juce::File());
         m.showMenuAsync(juce::PopupMenu::Options{}.withTargetComponent(&resizeBtn),
             [this](int r) {
-                if (r > 0) {
+                if (r > 0 && r <= 5) {
                     const float s[] = { 0.50f, 0.75f, 1.00f, 1.25f, 1.50f };
                     setScale(s[r - 1]);
                 }
+                if (r == 6) chooseImpulseResponse();
+                if (r == 7) proc.setImpulseResponse({});
             });
     };
 }
 
 DreamverbEditor::~DreamverbEditor() { setLookAndFeel(nullptr); }
 
+// Loading a response switches ALGORITHM to IR
+void DreamverbEditor::chooseImpulseResponse() {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    irChooser = std::make_unique<juce::FileChooser>("Impulse response", proc.getImpulseResponse(),
+                                                    formats.getWildcardForAllFormats());
+    irChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& fc) {
+            const auto file = fc.getResult();
+            if (file == juce::File()) return;
+            proc.setImpulseResponse(file);
+            if (auto* alg = proc.apvts.getParameter("algorithm"))
+                alg->setValueNotifyingHost(alg->convertTo0to1(3.0f));
+        });
+}
+
 void DreamverbEditor::setupLbl(juce::Label& l, const juce::String& t) {
     l.setText(t, juce::dontSendNotification);
     l.setFont(juce::Font(juce::FontOptions()
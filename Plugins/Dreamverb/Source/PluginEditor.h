@@ -177,6 +177,10 @@ private:
     using Att = juce::AudioProcessorValueTreeState::SliderAttachment;
     std::unique_ptr<Att> mixAtt, sizeAtt, toneAtt, shimAtt, dampAtt;
 
+    // Impulse response for ALGORITHM IR, picked from the corner menu
+    std::unique_ptr<juce::FileChooser> irChooser;
+    void chooseImpulseResponse();
+
     void setupLbl(juce::Label&, const juce::String&);
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DreamverbEditor)
 };
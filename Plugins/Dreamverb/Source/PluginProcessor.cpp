@@ -1,5 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Resample.h"
+#include <juce_audio_formats/juce_audio_formats.h>
 #include <cmath>
 #include <algorithm>
 
@@ -10,38 +12,277 @@ DreamverbProcessor::DreamverbProcessor()
       apvts(*this, nullptr, "Parameters", createParams())
 {}
 
+// Mono, stereo or any of the surround sets up to 7.1 out, fed the same
+// layout or mono
+bool DreamverbProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
+    const auto out = layouts.getMainOutputChannelSet(), in = layouts.getMainInputChannelSet();
+    if (in != out && in != juce::AudioChannelSet::mono()) return false;
+    using Set = juce::AudioChannelSet;
+    for (const auto& set : { Set::mono(), Set::stereo(), Set::createLCR(), Set::createLCRS(), Set::quadraphonic(),
+                             Set::create5point0(), Set::create5point1(), Set::create6point0(), Set::create6point1(),
+                             Set::create7point0(), Set::create7point1(), Set::create7point0SDDS(), Set::create7point1SDDS() })
+        if (out == set) return true;
+    return false;
+}
+
+DreamverbProcessor::~DreamverbProcessor() {
+    irLoader.stopThread(4000);
+    delete irIncoming.exchange(nullptr);
+    delete irRetired.exchange(nullptr);
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout DreamverbProcessor::createParams() {
     return {
         std::make_unique<juce::AudioParameterFloat>("mix",    "MIX",    0.0f, 1.0f, 0.4f),
         std::make_unique<juce::AudioParameterFloat>("size",   "SIZE",   0.0f, 1.0f, 0.6f),
         std::make_unique<juce::AudioParameterFloat>("damp",   "DAMP",   0.0f, 1.0f, 0.3f),
         std::make_unique<juce::AudioParameterFloat>("tone",   "TONE",   0.0f, 1.0f, 0.5f),
-        std::make_unique<juce::AudioParameterFloat>("param5", "SHIMMER",0.0f, 1.0f, 0.0f)
+        std::make_unique<juce::AudioParameterFloat>("param5", "SHIMMER",0.0f, 1.0f, 0.0f),
+        // 48k runs the tank near 48 kHz at high host rates (see setTankRate)
+        std::make_unique<juce::AudioParameterChoice>("tankrate", "TANK RATE",
+                                                     juce::StringArray { "Full", "48k" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("algorithm", "ALGORITHM",
+                                                     juce::StringArray { "Plate", "FDN 8", "FDN 16", "IR" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("shimheads", "SHIMMER HEADS",
+                                                     juce::StringArray { "2", "3", "4" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("early", "EARLY",
+                                                     juce::StringArray { "Off", "16", "32", "64" }, 0)
     };
 }
 
+// Halvings that take a host rate down to the 44.1 / 48 kHz the tank was
+// tuned at: 1 at 88.2 / 96 kHz, 2 at 176.4 / 192 kHz, 3 above
+static int tankStagesFor(double sr) {
+    int s = 0;
+    while (s < sc::Oversampler::kMaxStages && sr / (2 << s) >= 44100.0) s++;
+    return s;
+}
+
+// The modulated tank allpasses swing this many samples either way at the
+// plate's 29761 Hz, this many times a second
+static constexpr double kTankExcursion = 8.0;
+static constexpr double kTankLfoHz = 1.0;
+// Where each pair of wets taps its lines, as fractions of their lengths:
+// the first pair is the plate's own left and right, the rest spread out
+// from it so that no two wets read the same point
+static constexpr float kOutTapAt[4][4] = { { 0.31f, 0.18f, 0.38f, 0.27f },
+                                           { 0.57f, 0.44f, 0.66f, 0.52f },
+                                           { 0.83f, 0.71f, 0.12f, 0.79f },
+                                           { 0.45f, 0.91f, 0.58f, 0.09f } };
+// EARLY's tap counts, and its RMS gain on the input per channel
+static constexpr int   kEarlyTaps[] = { 0, 16, 32, 64 };
+static constexpr float kEarlyLevel  = 0.35f;
+
+// sr is the host rate; the tank is sized for the rate it runs at
 void DreamverbProcessor::initBuffers(double sr) {
-    const double r = sr / 29761.0;
+    const double r = sr / (1 << tankStages) / 29761.0;
     ap1.init((size_t)(142*r));  ap2.init((size_t)(107*r));
     ap3.init((size_t)(379*r));  ap4.init((size_t)(277*r));
-    tapL1.init((size_t)(672*r));  tapL2.init((size_t)(1800*r));
-    tapR1.init((size_t)(908*r));  tapR2.init((size_t)(2656*r));
+    tapL1.init((size_t)(672*r), (float)(kTankExcursion * r));  tapL2.init((size_t)(1800*r));
+    tapR1.init((size_t)(908*r), (float)(kTankExcursion * r));  tapR2.init((size_t)(2656*r));
+    tankLfo.setFrequency(kTankLfoHz / (sr / (1 << tankStages)));
+    tankLfo.setPhase(0.0);
     dL1.init((size_t)(4453*r));   dL2.init((size_t)(3720*r));
     dR1.init((size_t)(4217*r));   dR2.init((size_t)(3163*r));
+    for (int w = 0; w < kMaxWets; w++)
+        for (int k = 0; k < 4; k++)
+            outTap[w][k] = (size_t)((float)outTapLine(w, k).size() * kOutTapAt[w >> 1][k]);
+    size_t block = (size_t)sc::kRampChunk;
+    for (const auto* ap : { &ap1, &ap2, &ap3, &ap4, &tapL2, &tapR2 })
+        block = std::min(block, ap->size());
+    for (const auto* d : { &dL1, &dL2, &dR1, &dR2 })
+        block = std::min(block, d->size() - 2);
+    for (const auto& taps : outTap)
+        for (size_t t : taps) block = std::min(block, t - 1);
+    if (ir != nullptr && ir->conv != nullptr) ir->conv->reset();
+    early.setHalvings(tankStages);
+    fdn8.setSampleRate(sr / (1 << tankStages));
+    fdn16.setSampleRate(sr / (1 << tankStages));
+    block = std::min({ block, (size_t)fdn8.minDelay(), (size_t)fdn16.minDelay() });
+    tankBlock = std::max(1, (int)block);
     lpL = 0.f; lpR = 0.f;
-    toneLoL = toneLoR = toneHiL = toneHiR = 0.f;
-    dcX[0] = dcX[1] = dcY[0] = dcY[1] = 0.f;
-    std::fill(shimBufL, shimBufL + SHIMMER_BUF, 0.f);
-    std::fill(shimBufR, shimBufR + SHIMMER_BUF, 0.f);
+    for (auto* state : { toneLo, toneHi, dcX, dcY }) std::fill_n(state, kMaxWets, 0.f);
+    shifter.reset();
     shimSrcL = shimSrcR = 0.f;
     shimPostL = shimPostR = 0.f;
-    shimWrite = 0;
-    shimPhase = 0.0f;
+    sleep.reset();
+    // The plate's lines add up to more than either FDN's
+    const size_t irLength = ir != nullptr && ir->conv != nullptr ? ir->conv->length() : 0;
+    sleepHold = (int)std::max<size_t>({ (size_t)SHIMMER_BUF, irLength, early.length(),
+                                        tapL1.size() + dL1.size() + tapL2.size() + dL2.size()
+                                      + tapR1.size() + dR1.size() + tapR2.size() + dR2.size() })
+              << tankStages;
+}
+
+// Realtime safe once prepareToPlay has sized everything at the full rate:
+// the lines only shrink from there. Starts the tank over, empty.
+void DreamverbProcessor::setTankRate(int stages) {
+    tankStages = stages;
+    initBuffers(sampleRate);
+    resampler.setMode(stages, sc::Oversampler::Filter::minPhaseIIR);
+    decPending = 0;
+    for (auto* q : wetQueue) std::fill(q, q + sc::kRampChunk + 2 * kMaxTankFactor, 0.f);
+    wetQueued = (1 << stages) - 1;
+}
+
+static int wantedTankStages(juce::AudioProcessorValueTreeState& apvts, double sr) {
+    return *apvts.getRawParameterValue("tankrate") > 0.5f ? tankStagesFor(sr) : 0;
+}
+
+// ── Impulse response ─────────────────────────────────────────────────────
+
+// Wet level of noise through a response whose channels each have this much
+// energy (root sum of squares): the plate's at the default SIZE
+static constexpr float kIrLevel = 0.45f;
+
+// The file's first two channels (one serves both), resampled to rate,
+// scaled to kIrLevel and trimmed of whatever trails off under -100 dBFS.
+// nullptr when there is nothing to convolve with.
+static std::unique_ptr<sc::Convolver> loadConvolver(const juce::File& file, double rate) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0) return nullptr;
+    const int n = (int)std::min<juce::int64>(reader->lengthInSamples,
+                                             (juce::int64)(DreamverbProcessor::kMaxIrSeconds * reader->sampleRate));
+    juce::AudioBuffer<float> raw((int)std::min(2u, reader->numChannels), n);
+    reader->read(&raw, 0, n, 0, true, true);
+
+    std::vector<float> h[2];
+    h[0] = sc::resample(raw.getReadPointer(0), (size_t)n, reader->sampleRate, rate);
+    h[1] = raw.getNumChannels() > 1 ? sc::resample(raw.getReadPointer(1), (size_t)n, reader->sampleRate, rate) : h[0];
+    double energy = 0.0;
+    for (const auto& c : h)
+        for (float v : c) energy += (double)v * v;
+    if (energy <= 0.0) return nullptr;
+    const float gain = (float)(kIrLevel / std::sqrt(energy / 2.0));
+    size_t length = 0;
+    for (size_t i = 0; i < h[0].size(); i++) {
+        h[0][i] *= gain;
+        h[1][i] *= gain;
+        if (std::max(std::abs(h[0][i]), std::abs(h[1][i])) >= sc::kSilence) length = i + 1;
+    }
+    return std::make_unique<sc::Convolver>(h[0].data(), h[1].data(), length, rate);
+}
+
+void DreamverbProcessor::IrLoader::run() {
+    while (!threadShouldExit()) {
+        buildRequested();
+        wait(-1);
+    }
+}
+
+bool DreamverbProcessor::IrLoader::buildRequested() {
+    delete owner.irRetired.exchange(nullptr, std::memory_order_acquire);
+    const int request = owner.irRequest.load(std::memory_order_relaxed);
+    const int stages  = owner.irWantedStages.load(std::memory_order_relaxed);
+    if (stages < 0 || (request == builtRequest && stages == builtStages)) return false;
+    const double rate = owner.irHostRate.load(std::memory_order_relaxed) / (1 << stages);
+    juce::File file;
+    {
+        const juce::ScopedLock l(owner.irFileLock);
+        file = owner.irFile;
+    }
+    auto* engine = new IrEngine { file.existsAsFile() ? loadConvolver(file, rate) : nullptr, request, stages, rate };
+    // One built before it that the audio thread never took is out of date
+    delete owner.irIncoming.exchange(engine, std::memory_order_acq_rel);
+    builtRequest = request;
+    builtStages  = stages;
+    owner.irBuilt.signal();
+    return true;
+}
+
+// Once per block: posts the tank rate IR would run at (none unless
+// selected) and takes over any engine the loader has finished, once the
+// last one it replaced has gone back. An offline render waits for the one
+// it wants. The loader is only woken when there is work for it: a new rate
+// to build at, or an engine to free.
+void DreamverbProcessor::takeImpulseResponse() {
+    const int stages = algorithm == 3 ? tankStages : -1;
+    if (irWantedStages.exchange(stages, std::memory_order_relaxed) != stages)
+        irLoader.notify();
+    auto take = [&] {
+        if (irRetired.load(std::memory_order_acquire) != nullptr) return;
+        if (IrEngine* engine = irIncoming.exchange(nullptr, std::memory_order_acq_rel)) {
+            if (IrEngine* old = ir.release()) {
+                irRetired.store(old, std::memory_order_release);
+                irLoader.notify();
+            }
+            ir.reset(engine);
+            if (ir->conv != nullptr)
+                sleepHold = std::max(sleepHold, (int)ir->conv->length() << tankStages);
+            irSeconds.store(ir->conv != nullptr ? (double)ir->conv->length() / ir->rate : 0.0,
+                            std::memory_order_relaxed);
+        }
+    };
+    take();
+    auto current = [&] {
+        return ir != nullptr && ir->stages == stages && ir->request == irRequest.load(std::memory_order_relaxed);
+    };
+    if (stages >= 0 && isNonRealtime())
+        for (int tries = 0; tries < 1000 && !current() && irLoader.isThreadRunning(); tries++) {
+            irBuilt.wait(10);
+            take();
+        }
+}
+
+void DreamverbProcessor::setImpulseResponse(const juce::File& file) {
+    {
+        const juce::ScopedLock l(irFileLock);
+        irFile = file;
+    }
+    apvts.state.setProperty("irFile", file.getFullPathName(), nullptr);
+    irRequest.fetch_add(1, std::memory_order_relaxed);
+    irLoader.notify();
+}
+
+// The plate's tail, and with ALGORITHM IR the response's length on top
+static constexpr double kPlateTailSeconds = 6.0;
+
+double DreamverbProcessor::getTailLengthSeconds() const {
+    const bool irSelected = (int)*apvts.getRawParameterValue("algorithm") == 3;
+    return kPlateTailSeconds + (irSelected ? irSeconds.load(std::memory_order_relaxed) : 0.0);
+}
+
+juce::File DreamverbProcessor::getImpulseResponse() const {
+    const juce::ScopedLock l(irFileLock);
+    return irFile;
 }
 
-void DreamverbProcessor::prepareToPlay(double sr, int /*samplesPerBlock*/) {
+void DreamverbProcessor::prepareToPlay(double sr, int samplesPerBlock) {
     sampleRate = sr;
+    tankStages = 0;
+    // Every output channel but LFE gets a wet of its own
+    const auto outLayout = getChannelLayoutOfBus(false, 0);
+    inChannels  = getTotalNumInputChannels();
+    outChannels = std::min(getTotalNumOutputChannels(), kMaxChannels);
+    wets = 0;
+    for (int c = 0; c < outChannels; c++)
+        wetOf[c] = outLayout.getTypeOfChannel(c) == juce::AudioChannelSet::LFE || wets == kMaxWets ? -1 : wets++;
+    algorithm  = (int)*apvts.getRawParameterValue("algorithm");
+    fdn8.prepare(sr);
+    fdn16.prepare(sr);
+    early.prepare(sr, tankStagesFor(sr), kEarlyLevel);
+    // Heads sweep a 6144-sample grain, from 1536 to 7680 behind the source
+    shifter.prepare(SHIMMER_BUF, 6144, 1536);
     initBuffers(sr);
+    resampler.prepare(kMaxWets, sc::kRampChunk);
+    setTankRate(wantedTankStages(apvts, sr));
+    // IR starts with its response: built here with the loader stopped.
+    // Engines built at the old host rate go, so any left keyed to this
+    // tankStages is at this rate.
+    irLoader.stopThread(4000);
+    delete irIncoming.exchange(nullptr);
+    delete irRetired.exchange(nullptr);
+    ir.reset();
+    irSeconds.store(0.0, std::memory_order_relaxed);
+    irHostRate.store(sr, std::memory_order_relaxed);
+    irRequest.fetch_add(1, std::memory_order_relaxed);
+    takeImpulseResponse();
+    irLoader.buildRequested();
+    takeImpulseResponse();
+    irLoader.startThread(juce::Thread::Priority::low);
+    tailBuffer.setSize(outChannels, std::max(samplesPerBlock, sc::kRampChunk));
     smoothedMix.reset(sr, 0.02);     smoothedMix.setCurrentAndTargetValue(0.4f);
     smoothedSize.reset(sr, 0.05);    smoothedSize.setCurrentAndTargetValue(0.6f);
     smoothedDamp.reset(sr, 0.05);    smoothedDamp.setCurrentAndTargetValue(0.3f);
@@ -64,14 +305,23 @@ static inline float dcBlock(float x, float& xm1, float& ym1) {
     return y;
 }
 
-static float readInterp(const float* buf, int bufSize, float readPos) {
-    float wrapped = std::fmod(readPos, (float)bufSize);
-    if (wrapped < 0.f) wrapped += (float)bufSize;
-    int i0 = (int)wrapped & (bufSize - 1);
-    int i1 = (i0 + 1) & (bufSize - 1);
-    float frac = wrapped - (float)(int)wrapped;
-    return buf[i0] + frac * (buf[i1] - buf[i0]);
-}
+// Seconds round one half of the plate (tapL1, dL1, tapL2, dL2) at any rate
+static constexpr float kPlateHalfTrip = (672 + 4453 + 1800 + 3720) / 29761.0f;
+// Brings the FDN's wet level to the plate's at the default SIZE
+static constexpr float kFdnLevel = 0.14f;
+
+// Controls derived from the five smoothed parameters. Built once per chunk
+// on the steady path, once per sample only while a parameter is ramping.
+struct TankControls {
+    float mix, decay, dampCoef, tone, shimmer;
+    static TankControls make(float mix, float size, float damp, float tone, float shimmer) {
+        return { mix,
+                 std::min(0.5f + size * 0.43f, 0.93f),
+                 // damp=0->20kHz (bright), damp=1->500Hz (dark)
+                 0.0579f + damp * (0.9312f - 0.0579f),
+                 tone, shimmer };
+    }
+};
 
 void DreamverbProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
     juce::ScopedNoDenormals noDenormals;
@@ -81,153 +331,329 @@ void DreamverbProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Mi
     smoothedDamp.setTargetValue   (*apvts.getRawParameterValue("damp"));
     smoothedTone.setTargetValue   (*apvts.getRawParameterValue("tone"));
     smoothedShimmer.setTargetValue(*apvts.getRawParameterValue("param5"));
+    if (const int stages = wantedTankStages(apvts, sampleRate); stages != tankStages)
+        setTankRate(stages);
+    if (const int alg = (int)*apvts.getRawParameterValue("algorithm"); alg != algorithm) {
+        algorithm = alg;
+        initBuffers(sampleRate);
+    }
+    shifter.setHeads(2 + (int)*apvts.getRawParameterValue("shimheads"));
+    early.setTaps(kEarlyTaps[(int)*apvts.getRawParameterValue("early")]);
+    takeImpulseResponse();
+    sc::Convolver* const irConv = algorithm == 3 && ir != nullptr && ir->stages == tankStages
+                                ? ir->conv.get() : nullptr;
+    if (irConv != nullptr) irConv->setOffline(isNonRealtime());
+
+    const int N    = buffer.getNumSamples();
+    const int ins  = std::min(inChannels, buffer.getNumChannels());
+    const int outs = std::min(outChannels, buffer.getNumChannels());
+
+    // ── Sleep: silent in, nothing left in the tank — only the dry gain ──
+    // A mono input goes out of every channel
+    const float inPeak = sc::blockPeak(buffer.getArrayOfReadPointers(), ins, N);
+    if (sleep.sleep(inPeak)) {
+        for (auto* sm : { &smoothedMix, &smoothedSize, &smoothedDamp, &smoothedTone, &smoothedShimmer })
+            sm->skip(N);
+        for (int c = ins; c < outs; c++) buffer.copyFrom(c, 0, buffer, 0, 0, N);
+        buffer.applyGain(1.0f - smoothedMix.getCurrentValue());
+        return;
+    }
 
-    const int N  = buffer.getNumSamples();
-    const int ch = buffer.getNumChannels();
-    auto* L = buffer.getWritePointer(0);
-    auto* R = ch > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0);
-
-    const int   shimWindow = (SHIMMER_BUF * 3) / 4;  // 6144 — AM rate 14Hz, below audibility
-    const float pitchRatio = 2.0f;             // octave up
+    // The tank's mono input: the mean of the input channels, LFE aside
+    const float* tankIn[kMaxChannels];
+    int tankIns = 0;
+    for (int c = 0; c < ins; c++)
+        if (ins == 1 || wetOf[c] >= 0) tankIn[tankIns++] = buffer.getReadPointer(c);
+    const float inScale = 1.0f / (float)tankIns;
+    auto mixDown = [&](float* to, const int start, const int n) {
+        std::copy_n(tankIn[0] + start, n, to);
+        for (int c = 1; c < tankIns; c++)
+            for (int i = 0; i < n; i++) to[i] += tankIn[c][start + i];
+        for (int i = 0; i < n; i++) to[i] *= inScale;
+    };
+    float tailPeak = 0.0f;
 
     // Filter coefficients — computed ONCE per block, not per sample
     // std::exp is expensive; calling it 44100x/sec per filter is wasteful and wrong
-    const float shimSrcA  = std::exp(-2.0f * juce::MathConstants<float>::pi * 6000.0f  / (float)sampleRate);
-    const float shimPostA = std::exp(-2.0f * juce::MathConstants<float>::pi * 8000.0f  / (float)sampleRate);
-    const float loAlpha   = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * 400.0f  / (float)sampleRate);
-    const float hiAlpha   = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * 3200.0f / (float)sampleRate);
-
-    for (int i = 0; i < N; i++) {
-        const float mix     = smoothedMix.getNextValue();
-        const float size    = smoothedSize.getNextValue();
-        const float damp    = smoothedDamp.getNextValue();
-        const float tone    = smoothedTone.getNextValue();
-        const float shimmer = smoothedShimmer.getNextValue();
-
-        const float dry0 = L[i];
-        const float dry1 = R[i];
-
-        // ── Input diffusion ──────────────────────────────────────────────
-        float mono = (dry0 + dry1) * 0.5f;
-        float d = ap1.process(mono, 0.70f);
-        d = ap2.process(d, 0.70f);
-        d = ap3.process(d, 0.625f);
-        d = ap4.process(d, 0.625f);
-
-        // ── Shimmer: octave-up via two overlapping Hanning-windowed heads ─
-        float shimL = 0.0f, shimR = 0.0f;
-        if (shimmer > 0.001f) {
-            const float base    = (float)shimWrite;
-            const float windowF = (float)shimWindow;
-
-            // Read positions: head A sweeps forward through the window,
-            // head B is offset by half window for continuous crossfade coverage
-            float readA = base - windowF * 1.25f + shimPhase * windowF;
-            float readB = base - windowF * 1.75f + shimPhase * windowF;
-
-            // Wrap into [0, SHIMMER_BUF)
-            auto wrapRead = [](float x, float len) {
-                x = std::fmod(x, len);
-                if (x < 0.0f) x += len;
-                return x;
-            };
-            readA = wrapRead(readA, (float)SHIMMER_BUF);
-            readB = wrapRead(readB, (float)SHIMMER_BUF);
-
-            // Hann windows — sum to 1.0 at all phases (complementary)
-            const float winA = 0.5f * (1.0f - std::cos(juce::MathConstants<float>::twoPi * shimPhase));
-            const float winB = 1.0f - winA;
-
-            shimL = winA * readInterp(shimBufL, SHIMMER_BUF, readA)
-                  + winB * readInterp(shimBufL, SHIMMER_BUF, readB);
-            shimR = winA * readInterp(shimBufR, SHIMMER_BUF, readA)
-                  + winB * readInterp(shimBufR, SHIMMER_BUF, readB);
-
-            // Post-filter shimmer output — suppresses edge artifacts
-            shimPostL = (1.0f - shimPostA) * shimL + shimPostA * shimPostL;
-            shimPostR = (1.0f - shimPostA) * shimR + shimPostA * shimPostR;
-            shimL = shimPostL;
-            shimR = shimPostR;
-
-            // FIX: phase increment must be pitchRatio/shimWindow for correct octave-up
-            // (pitchRatio-1)/shimWindow gives HALF speed — incomplete crossfade = flutter
-            shimPhase += pitchRatio / (float)shimWindow;
-            if (shimPhase >= 1.0f) shimPhase -= 1.0f;
+    // at the rate the tank runs at
+    const float tankRate  = (float)(sampleRate / (1 << tankStages));
+    const float shimSrcA  = std::exp(-2.0f * juce::MathConstants<float>::pi * 6000.0f  / tankRate);
+    const float shimPostA = std::exp(-2.0f * juce::MathConstants<float>::pi * 8000.0f  / tankRate);
+    const float loAlpha   = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * 400.0f  / tankRate);
+    const float hiAlpha   = 1.0f - std::exp(-2.0f * juce::MathConstants<float>::pi * 3200.0f / tankRate);
+
+    // n samples of mono input through the tank to wet[0 .. wets), a stage
+    // at a time: each stage runs over a sub-block of up to tankBlock samples
+    // before the next one starts. tankBlock is shorter than every delay a
+    // stage reads back across (see initBuffers), so nothing in a sub-block
+    // reads what the same sub-block writes, and the output is what running
+    // every stage sample by sample gives. ctl(i) returns the controls for
+    // sample i.
+    auto runTank = [&](const float* in, float* const* wet, const int n, auto&& ctl) {
+        for (int from = 0, m = 0; from < n; from += m) {
+            m = std::min(tankBlock, n - from);
+            auto c = [&](const int i) -> const TankControls& { return ctl(from + i); };
+
+            // ── Shimmer: octave-up grains from the wet so far ──────────
+            // The heads stay further behind the source than a sub-block is
+            // long, so they never read what this one writes. SHIMMER ramps
+            // linearly, so its ends say whether it is up anywhere in between.
+            float shimFeed[sc::kRampChunk];
+            if (std::max(c(0).shimmer, c(m - 1).shimmer) > 0.001f) {
+                float shimL[sc::kRampChunk], shimR[sc::kRampChunk];
+                shifter.process(shimL, shimR, m);
+                for (int i = 0; i < m; i++) {
+                    // Post-filter shimmer output — suppresses edge artifacts
+                    shimPostL = (1.0f - shimPostA) * shimL[i] + shimPostA * shimPostL;
+                    shimPostR = (1.0f - shimPostA) * shimR[i] + shimPostA * shimPostR;
+                    // FIX: shimmer feed gain 0.20 (not 0.60 — that was 3x too loud, caused crunch)
+                    shimFeed[i] = (shimPostL + shimPostR) * 0.5f * 0.35f * c(i).shimmer;
+                    shimFeed[i] = std::max(-0.80f, std::min(0.80f, shimFeed[i]));
+                }
+            } else {
+                std::fill_n(shimFeed, m, 0.0f);
+            }
+
+            // ── Early reflections ────────────────────────────────────────
+            // Off the undiffused input; they join the tank's input here and
+            // its output below. An impulse response brings its own.
+            float d[sc::kRampChunk], erL[sc::kRampChunk], erR[sc::kRampChunk];
+            std::copy_n(in + from, m, d);
+            const bool reflect = early.taps() > 0 && algorithm != 3;
+            if (reflect) {
+                early.process(d, erL, erR, m);
+                for (int i = 0; i < m; i++) d[i] += 0.5f * (erL[i] + erR[i]);
+            }
+
+            // ── Input diffusion ──────────────────────────────────────────
+            // An impulse response brings its own
+            if (algorithm != 3) {
+                ap1.process(d, d, (size_t)m, 0.70f);
+                ap2.process(d, d, (size_t)m, 0.70f);
+                ap3.process(d, d, (size_t)m, 0.625f);
+                ap4.process(d, d, (size_t)m, 0.625f);
+            }
+            for (int i = 0; i < m; i++) d[i] = softLimit(d[i] + shimFeed[i]);
+
+            float tank[kMaxWets][sc::kRampChunk];
+            if (algorithm == 0) {
+                // ── Output taps ──────────────────────────────────────────
+                // Each is read(outTap) just after its sample's pushes, which is
+                // outTap - 1 back from where the sub-block starts, so every
+                // wet is summed before the tank runs. Only the wets in use
+                // read theirs: mono out reads four taps, not eight.
+                for (int w = 0; w < wets; w++) {
+                    float taps[4][sc::kRampChunk];
+                    for (int k = 0; k < 4; k++)
+                        outTapLine(w, k).read(outTap[w][k] - 1, taps[k], (size_t)m);
+                    for (int i = 0; i < m; i++)
+                        tank[w][i] = 0.432f * taps[0][i]
+                                   + 0.180f * taps[1][i]
+                                   - 0.108f * taps[2][i]
+                                   - 0.072f * taps[3][i];
+                }
+
+                // ── Dattorro plate tank ──────────────────────────────────
+                // The left half reads dR2 before the sample's push to it; the
+                // lowpasses and the right half read lines just pushed, hence
+                // size() - 2
+                float fb[sc::kRampChunk], node[sc::kRampChunk];
+                float lfoSin[sc::kRampChunk], lfoCos[sc::kRampChunk];
+                tankLfo.fill(lfoSin, lfoCos, m);
+                dR2.read(dR2.size() - 1, fb, (size_t)m);
+                for (int i = 0; i < m; i++) node[i] = softLimit(d[i] + c(i).decay * fb[i]);
+                tapL1.process(node, node, (size_t)m, 0.7f, lfoSin);
+                dL1.read(dL1.size() - 2, fb, (size_t)m);
+                dL1.push(node, (size_t)m);
+                for (int i = 0; i < m; i++) {
+                    lpL = lpL + c(i).dampCoef * (fb[i] - lpL);
+                    node[i] = c(i).decay * lpL;
+                }
+                tapL2.process(node, node, (size_t)m, 0.5f);
+                dL2.read(dL2.size() - 2, fb, (size_t)m);
+                dL2.push(node, (size_t)m);
+
+                for (int i = 0; i < m; i++) node[i] = softLimit(d[i] + c(i).decay * fb[i]);
+                tapR1.process(node, node, (size_t)m, 0.7f, lfoCos);
+                dR1.read(dR1.size() - 2, fb, (size_t)m);
+                dR1.push(node, (size_t)m);
+                for (int i = 0; i < m; i++) {
+                    lpR = lpR + c(i).dampCoef * (fb[i] - lpR);
+                    node[i] = c(i).decay * lpR;
+                }
+                tapR2.process(node, node, (size_t)m, 0.5f);
+                dR2.push(node, (size_t)m);
+            } else if (algorithm < 3) {
+                // ── Feedback delay network ───────────────────────────────
+                // Loses what the plate does per second at this SIZE and DAMP:
+                // decay, and its lowpass's a / (2 - a) more at Nyquist, every
+                // half trip. Follows the controls once per sub-block. Each
+                // wet is one of its output patterns.
+                const TankControls& k = c(0);
+                const float nyquist = k.decay * k.dampCoef / (2.0f - k.dampCoef);
+                float* out[kMaxWets];
+                for (int w = 0; w < wets; w++) out[w] = tank[w];
+                if (algorithm == 1) {
+                    fdn8.setDecay(k.decay, nyquist, kPlateHalfTrip);
+                    fdn8.process(d, out, wets, m);
+                } else {
+                    fdn16.setDecay(k.decay, nyquist, kPlateHalfTrip);
+                    fdn16.process(d, out, wets, m);
+                }
+                for (int w = 0; w < wets; w++)
+                    for (int i = 0; i < m; i++) tank[w][i] *= kFdnLevel;
+            } else if (irConv != nullptr) {
+                // ── Impulse response ─────────────────────────────────────
+                // Two channels, both made at the cost of one; surround wets
+                // take the side they lean to
+                irConv->process(d, tank[0], tank[1], m);
+                for (int w = 2; w < wets; w++) std::copy_n(tank[w & 1], m, tank[w]);
+            } else {
+                // Nothing loaded yet, or not at this rate
+                for (int w = 0; w < wets; w++) std::fill_n(tank[w], m, 0.0f);
+            }
+            if (reflect) {
+                const float* er[2] = { erL, erR };
+                for (int w = 0; w < wets; w++)
+                    for (int i = 0; i < m; i++) tank[w][i] += er[w & 1][i];
+            }
+
+            // DC blocker
+            for (int w = 0; w < wets; w++)
+                for (int i = 0; i < m; i++) tank[w][i] = dcBlock(tank[w][i], dcX[w], dcY[w]);
+
+            // Shimmer source buffer — low-pass before writing reduces aliasing in pitch shift.
+            // Off the front pair, or the one wet of a mono output.
+            const float* srcR = tank[wets > 1 ? 1 : 0];
+            for (int i = 0; i < m; i++) {
+                shimSrcL = (1.0f - shimSrcA) * tank[0][i] + shimSrcA * shimSrcL;
+                shimSrcR = (1.0f - shimSrcA) * srcR[i]    + shimSrcA * shimSrcR;
+                shifter.push(shimSrcL, shimSrcR);
+            }
+
+            // ── Tone: tilt EQ — center (0.5) is flat ─────────────────────
+            // Below 0.5: crossfade toward 400Hz LP (darker)
+            // Above 0.5: add HF shelf boost via 3200Hz HP component
+            for (int w = 0; w < wets; w++) {
+                float lo = toneLo[w], hi = toneHi[w];
+                for (int i = 0; i < m; i++) {
+                    const float tone = c(i).tone;
+                    const float out = tank[w][i];
+                    lo += loAlpha * (out - lo);
+                    hi += hiAlpha * (out - hi);
+                    float v;
+                    if (tone <= 0.5f) {
+                        float t = tone * 2.0f;
+                        v = lo + t * (out - lo);
+                    } else {
+                        float t = (tone - 0.5f) * 2.0f;
+                        v = out + t * 0.25f * (out - hi);
+                    }
+                    wet[w][from + i] = softLimit(v);
+                    tailPeak = std::max(tailPeak, std::abs(wet[w][from + i]));
+                }
+                toneLo[w] = lo;
+                toneHi[w] = hi;
+            }
         }
+    };
 
-        // FIX: shimmer feed gain 0.20 (not 0.60 — that was 3x too loud, caused crunch)
-        // squared curve for natural feel at low settings
-        const float shimAmt  = shimmer;
-        float shimFeed = (shimL + shimR) * 0.5f * 0.35f * shimAmt;
-        shimFeed = std::max(-0.80f, std::min(0.80f, shimFeed));
-        d = softLimit(d + shimFeed);
-
-        // ── Dattorro plate tank ──────────────────────────────────────────
-        const float decay    = std::min(0.5f + size * 0.43f, 0.93f);
-        // damp=0->20kHz (bright), damp=1->500Hz (dark)
-        const float dampCoef = 0.0579f + damp * (0.9312f - 0.0579f);
-
-        float nodeL = softLimit(d + decay * dR2.read(dR2.size() - 1));
-        nodeL = tapL1.process(nodeL, 0.7f);
-        dL1.push(nodeL);
-        lpL = lpL + dampCoef * (dL1.read(dL1.size() - 1) - lpL);
-        float tankL = decay * lpL;
-        tankL = tapL2.process(tankL, 0.5f);
-        dL2.push(tankL);
-
-        float nodeR = softLimit(d + decay * dL2.read(dL2.size() - 1));
-        nodeR = tapR1.process(nodeR, 0.7f);
-        dR1.push(nodeR);
-        lpR = lpR + dampCoef * (dR1.read(dR1.size() - 1) - lpR);
-        float tankR = decay * lpR;
-        tankR = tapR2.process(tankR, 0.5f);
-        dR2.push(tankR);
-
-        float outL = 0.432f * dL1.read((size_t)(dL1.size() * 0.31f))
-                   + 0.180f * dL2.read((size_t)(dL2.size() * 0.18f))
-                   - 0.108f * dR1.read((size_t)(dR1.size() * 0.38f))
-                   - 0.072f * dR2.read((size_t)(dR2.size() * 0.27f));
-
-        float outR = 0.432f * dR1.read((size_t)(dR1.size() * 0.31f))
-                   + 0.180f * dR2.read((size_t)(dR2.size() * 0.18f))
-                   - 0.108f * dL1.read((size_t)(dL1.size() * 0.38f))
-                   - 0.072f * dL2.read((size_t)(dL2.size() * 0.27f));
-
-        // DC blocker
-        outL = dcBlock(outL, dcX[0], dcY[0]);
-        outR = dcBlock(outR, dcX[1], dcY[1]);
-
-        // Shimmer source buffer — low-pass before writing reduces aliasing in pitch shift
-        shimSrcL = (1.0f - shimSrcA) * outL + shimSrcA * shimSrcL;
-        shimSrcR = (1.0f - shimSrcA) * outR + shimSrcA * shimSrcR;
-        shimBufL[shimWrite & (SHIMMER_BUF - 1)] = shimSrcL;
-        shimBufR[shimWrite & (SHIMMER_BUF - 1)] = shimSrcR;
-        shimWrite = (shimWrite + 1) & (SHIMMER_BUF - 1);
-
-        // ── Tone: tilt EQ — center (0.5) is flat ─────────────────────────
-        // Below 0.5: crossfade toward 400Hz LP (darker)
-        // Above 0.5: add HF shelf boost via 3200Hz HP component
-        toneLoL += loAlpha * (outL - toneLoL);
-        toneLoR += loAlpha * (outR - toneLoR);
-        toneHiL += hiAlpha * (outL - toneHiL);
-        toneHiR += hiAlpha * (outR - toneHiR);
-
-        float wetL, wetR;
-        if (tone <= 0.5f) {
-            float t = tone * 2.0f;
-            wetL = toneLoL + t * (outL - toneLoL);
-            wetR = toneLoR + t * (outR - toneLoR);
+    // Steady parameters (the usual case) run with the controls hoisted;
+    // only chunks where a smoother is moving build them per sample.
+    for (int start = 0; start < N; start += sc::kRampChunk) {
+        const int n = std::min(sc::kRampChunk, N - start);
+        rampMix.fill(smoothedMix, n);
+        rampSize.fill(smoothedSize, n);
+        rampDamp.fill(smoothedDamp, n);
+        rampTone.fill(smoothedTone, n);
+        rampShimmer.fill(smoothedShimmer, n);
+        const bool moving = sc::anyMoving(rampMix, rampSize, rampDamp, rampTone, rampShimmer);
+        const auto steady = TankControls::make(rampMix.steady, rampSize.steady, rampDamp.steady,
+                                               rampTone.steady, rampShimmer.steady);
+        TankControls ctl[sc::kRampChunk];
+
+        float wetBuf[kMaxWets][sc::kRampChunk];
+        float* wet[kMaxWets];
+        for (int w = 0; w < kMaxWets; w++) wet[w] = wetBuf[w];
+        if (tankStages == 0) {
+            float mono[sc::kRampChunk];
+            mixDown(mono, start, n);
+            if (moving) {
+                for (int i = 0; i < n; i++)
+                    ctl[i] = TankControls::make(rampMix[i], rampSize[i], rampDamp[i], rampTone[i], rampShimmer[i]);
+                runTank(mono, wet, n, [&](int i) -> const TankControls& { return ctl[i]; });
+            } else {
+                runTank(mono, wet, n, [&](int) -> const TankControls& { return steady; });
+            }
         } else {
-            float t = (tone - 0.5f) * 2.0f;
-            wetL = outL + t * 0.25f * (outL - toneHiL);
-            wetR = outR + t * 0.25f * (outR - toneHiR);
+            // ── Decimated tank ───────────────────────────────────────────
+            // The mono input queues up behind what is left of the last
+            // chunk; every whole frame of tankFactor samples goes through
+            // the tank as one. Each tank sample takes its controls from the
+            // host sample that completes its frame.
+            const int pending = decPending, total = pending + n;
+            const int k = total >> tankStages, used = k << tankStages;
+            mixDown(decIn + pending, start, n);
+            float lo[sc::kRampChunk], loWetBuf[kMaxWets][sc::kRampChunk];
+            float* loWet[kMaxWets];
+            for (int w = 0; w < kMaxWets; w++) loWet[w] = loWetBuf[w];
+            resampler.decimate(0, decIn, lo, k);
+            std::copy(decIn + used, decIn + total, decIn);
+            decPending = total - used;
+
+            if (moving) {
+                for (int j = 0; j < k; j++) {
+                    const int i = std::clamp(((j + 1) << tankStages) - 1 - pending, 0, n - 1);
+                    ctl[j] = TankControls::make(rampMix[i], rampSize[i], rampDamp[i], rampTone[i], rampShimmer[i]);
+                }
+                runTank(lo, loWet, k, [&](int j) -> const TankControls& { return ctl[j]; });
+            } else {
+                runTank(lo, loWet, k, [&](int) -> const TankControls& { return steady; });
+            }
+
+            // Back up to the host rate, behind the wet still queued. The
+            // queue started tankFactor - 1 samples deep, which keeps at
+            // least n in it here.
+            for (int w = 0; w < wets; w++) {
+                const float* hi = resampler.up(w, loWet[w], k);
+                std::copy(hi, hi + used, wetQueue[w] + wetQueued);
+                std::copy_n(wetQueue[w], n, wet[w]);
+                std::copy(wetQueue[w] + n, wetQueue[w] + wetQueued + used, wetQueue[w]);
+            }
+            wetQueued += used - n;
         }
 
-        wetL = softLimit(wetL);
-        wetR = softLimit(wetR);
+        // ── Mix, at the host rate ────────────────────────────────────────
+        // Last channel first: a mono input's dry is channel 0, which is
+        // written over last. LFE gets its dry at the same gain, no wet.
+        for (int ch = outs - 1; ch >= 0; ch--) {
+            const float* dry = buffer.getReadPointer(ins == 1 ? 0 : ch) + start;
+            float* out = buffer.getWritePointer(ch) + start;
+            if (wetOf[ch] < 0) {
+                for (int i = 0; i < n; i++) out[i] = softLimit((1.0f - rampMix[i]) * dry[i]);
+                continue;
+            }
+            const float* w = wet[wetOf[ch]];
+            for (int i = 0; i < n; i++) {
+                const float mix = rampMix[i];
+                out[i] = softLimit((1.0f - mix) * dry[i] + mix * w[i]);
+            }
+        }
+    }
+    sleep.update(inPeak, tailPeak, N, sleepHold);
+}
 
-        L[i] = softLimit((1.0f - mix) * dry0 + mix * wetL);
-        R[i] = softLimit((1.0f - mix) * dry1 + mix * wetR);
+// Bypassed, the dry signal passes untouched and the tank, fed silence,
+// rings out on top of it until it sleeps
+void DreamverbProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) {
+    const int N = buffer.getNumSamples(), ch = std::min(buffer.getNumChannels(), outChannels);
+    for (int start = 0; start < N && !sleep.asleep(); start += tailBuffer.getNumSamples()) {
+        const int n = std::min(tailBuffer.getNumSamples(), N - start);
+        juce::AudioBuffer<float> tail(tailBuffer.getArrayOfWritePointers(), outChannels, n);
+        tail.clear();
+        processBlock(tail, midi);
+        for (int c = 0; c < ch; c++)
+            buffer.addFrom(c, start, tail.getReadPointer(c), n);
     }
 }
 
@@ -239,8 +665,11 @@ void DreamverbProcessor::getStateInformation(juce::MemoryBlock& destData) {
 
 void DreamverbProcessor::setStateInformation(const void* data, int sizeInBytes) {
     std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
-    if (xml && xml->hasTagName(apvts.state.getType()))
+    if (xml && xml->hasTagName(apvts.state.getType())) {
         apvts.replaceState(juce::ValueTree::fromXml(*xml));
+        const auto path = apvts.state.getProperty("irFile").toString();
+        setImpulseResponse(path.isNotEmpty() ? juce::File(path) : juce::File());
+    }
 }
 
 juce::AudioProcessorEditor* DreamverbProcessor::createEditor() {
@@ -1,22 +1,35 @@
 #pragma once
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include "ParamRamp.h"
+#include "SleepGate.h"
+#include "Oversampler.h"
+#include "FDN.h"
+#include "Convolver.h"
+#include "PitchShifter.h"
+#include "QuadratureOsc.h"
+#include "EarlyReflections.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <cstddef>
 
 class DreamverbProcessor : public juce::AudioProcessor {
 public:
     DreamverbProcessor();
-    ~DreamverbProcessor() override = default;
+    ~DreamverbProcessor() override;
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override {}
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    bool isBusesLayoutSupported(const BusesLayout&) const override;
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
     const juce::String getName() const override { return "Dreamverb"; }
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
-    double getTailLengthSeconds() const override { return 6.0; }
+    double getTailLengthSeconds() const override;
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
     void setCurrentProgram(int) override {}
@@ -27,51 +40,229 @@ public:
     juce::AudioProcessorValueTreeState apvts;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParams();
 
+    // ALGORITHM IR's impulse response: any file the basic formats read,
+    // its first two channels, up to kMaxIrSeconds. Saved with the state and
+    // loaded in the background. Message thread.
+    void setImpulseResponse(const juce::File& file);
+    juce::File getImpulseResponse() const;
+    static constexpr double kMaxIrSeconds = 20.0;
+
 private:
-    struct AllpassFilter {
+    // Delay line on a power-of-two buffer. The logical length (size()) is
+    // independent of the allocation, so every index wraps with a mask
+    // instead of an integer modulo.
+    struct DelayLine {
         std::vector<float> buf;
-        size_t writePos = 0, sz = 0;
-        void init(size_t n) { sz = n; buf.assign(n, 0.f); writePos = 0; }
+        size_t writePos = 0, mask = 0, sz = 0;
+        void init(size_t n) {
+            sz = n;
+            buf.assign((size_t)juce::nextPowerOfTwo((int)n + 1), 0.f);
+            mask = buf.size() - 1;
+            writePos = 0;
+        }
+        void push(float v) { buf[writePos] = v; writePos = (writePos + 1) & mask; }
+        // d = 1 is the newest sample, d = size() the oldest
+        float read(size_t d) const { return buf[(writePos - d) & mask]; }
+        size_t size() const { return sz; }
+
+        // What read(d) gives over the next n pushes - out[i] after i of
+        // them - for d >= n, so none of it is written by those pushes
+        void read(size_t d, float* out, size_t n) const {
+            const size_t from = (writePos - d) & mask, first = std::min(n, buf.size() - from);
+            std::copy_n(buf.data() + from, first, out);
+            std::copy_n(buf.data(), n - first, out + first);
+        }
+        void push(const float* in, size_t n) {
+            const size_t first = std::min(n, buf.size() - writePos);
+            std::copy_n(in, first, buf.data() + writePos);
+            std::copy_n(in + first, n - first, buf.data());
+            writePos = (writePos + n) & mask;
+        }
+    };
+    struct AllpassFilter {
+        DelayLine line;
+        void init(size_t n) { line.init(n); }
         float process(float in, float g) {
-            float delayed = buf[writePos];
+            float delayed = line.read(line.size());
             float w = in + g * delayed;
-            buf[writePos] = w;
-            writePos = (writePos + 1) % sz;
+            line.push(w);
             return delayed - g * w;
         }
-        size_t size() const { return sz; }
+        // n samples at once (in and out may be the same), n <= size(): every
+        // delayed sample is from before the block, so the ring is worked on
+        // in place a contiguous stretch at a time
+        void process(const float* in, float* out, size_t n, float g) {
+            float* const buf = line.buf.data();
+            for (size_t done = 0; done < n; ) {
+                const size_t rd = (line.writePos - line.sz) & line.mask, wr = line.writePos;
+                const size_t k = std::min({ n - done, line.buf.size() - rd, line.buf.size() - wr });
+                const float* d = buf + rd;
+                float* w = buf + wr;
+                const float* x = in + done;
+                float* y = out + done;
+                for (size_t i = 0; i < k; i++) {
+                    const float delayed = d[i];
+                    const float v = x[i] + g * delayed;
+                    w[i] = v;
+                    y[i] = delayed - g * v;
+                }
+                line.writePos = (wr + k) & line.mask;
+                done += k;
+            }
+        }
+        size_t size() const { return line.size(); }
     };
-    struct DelayTap {
-        std::vector<float> buf;
-        size_t writePos = 0, sz = 0;
-        void init(size_t n) { sz = n; buf.assign(n, 0.f); writePos = 0; }
-        void push(float v) { buf[writePos] = v; writePos = (writePos + 1) % sz; }
-        float read(size_t d) const { return buf[(writePos + sz - (d % sz)) % sz]; }
-        size_t size() const { return sz; }
+    // Dattorro's modulated tank allpass: the delay swings depth samples
+    // either side of size() as lfo runs from -1 to 1, read between samples
+    // by linear interpolation. Sample by sample, so blocks of any length.
+    struct ModulatedAllpass {
+        DelayLine line;
+        size_t centre = 0;
+        float  depth = 0.f;
+        void init(size_t n, float excursion) {
+            centre = n;
+            depth  = excursion;
+            line.init(n + (size_t)std::ceil(excursion) + 1);
+        }
+        void process(const float* in, float* out, size_t n, float g, const float* lfo) {
+            float* const buf = line.buf.data();
+            size_t wr = line.writePos;
+            for (size_t i = 0; i < n; i++) {
+                const float d = (float)centre + depth * lfo[i];
+                const size_t di = (size_t)d;
+                const float frac = d - (float)di;
+                const float a = buf[(wr - di) & line.mask], b = buf[(wr - di - 1) & line.mask];
+                const float delayed = a + frac * (b - a);
+                const float v = in[i] + g * delayed;
+                buf[wr] = v;
+                wr = (wr + 1) & line.mask;
+                out[i] = delayed - g * v;
+            }
+            line.writePos = wr;
+        }
+        size_t size() const { return centre; }
     };
 
     AllpassFilter ap1, ap2, ap3, ap4;
-    AllpassFilter tapL1, tapL2, tapR1, tapR2;
-    DelayTap dL1, dL2, dR1, dR2;
+    ModulatedAllpass tapL1, tapR1;   // swung by tankLfo's sine and cosine
+    AllpassFilter tapL2, tapR2;
+    sc::QuadratureOsc tankLfo;
+    DelayLine dL1, dL2, dR1, dR2;
+
+    // The tank makes one wet per output channel but LFE, up to kMaxWets:
+    // 0 / 1 are left / right, and any more are for surround. Each has its
+    // own four plate taps (offsets below, fixed by initBuffers), left-led
+    // for an even wet and right-led for an odd one, its own FDN output
+    // pattern, and its own post-tank filters. Only the wets in use run.
+    static constexpr int kMaxWets = sc::FDN<8>::kMaxOutputs;
+    static constexpr int kMaxChannels = 8;
+    size_t outTap[kMaxWets][4] = {};
+    // The line wet w's tap k reads: dL1, dL2, dR1, dR2 for a left-led wet,
+    // the mirror image for a right-led one
+    const DelayLine& outTapLine(int w, int k) const {
+        const DelayLine* const lines[2][4] = { { &dL1, &dL2, &dR1, &dR2 }, { &dR1, &dR2, &dL1, &dL2 } };
+        return *lines[w & 1][k];
+    }
+    // Taken from the layout in prepareToPlay: the wet each output channel
+    // gets, -1 for LFE, which gets the dry only
+    int inChannels = 2, outChannels = 2, wets = 2;
+    int wetOf[kMaxChannels] = { 0, 1 };
+    // Longest sub-block the tank runs stage by stage: under every delay a
+    // stage reads back across, up to kRampChunk
+    int tankBlock = 1;
     float lpL = 0.f, lpR = 0.f;
-    float toneLoL = 0.f, toneLoR = 0.f, toneHiL = 0.f, toneHiR = 0.f;
+    float toneLo[kMaxWets] = {}, toneHi[kMaxWets] = {};
+
+    // ALGORITHM: 0 = the plate above, 1 / 2 = an 8 / 16-line FDN in its
+    // place, between the same input diffusion and output stages, 3 = IR
+    // (below), which takes the input undiffused
+    // EARLY: sparse reflections off the undiffused input, into both the
+    // tank and the wet, ahead of any tank but IR's
+    sc::EarlyReflections early;
+
+    sc::FDN<8>  fdn8;
+    sc::FDN<16> fdn16;
+    int algorithm = 0;
 
-    // DC blocker state (one per channel)
-    float dcX[2] = {}, dcY[2] = {};
+    // DC blocker state (one per wet)
+    float dcX[kMaxWets] = {}, dcY[kMaxWets] = {};
 
+    // Shimmer: an octave up from the wet, SHIMMER HEADS grains at a time.
+    // The source is written whatever SHIMMER is; the heads only run while
+    // it is up.
     static constexpr int SHIMMER_BUF = 8192;
-    float shimBufL[SHIMMER_BUF] = {};
-    float shimBufR[SHIMMER_BUF] = {};
-    // FIX: shimWrite stays bounded in [0, SHIMMER_BUF) — prevents float precision
-    // loss when cast to float for read head calculation after ~6 minutes of playback
-    int shimWrite = 0;
-    float shimPhase = 0.0f;
+    sc::PitchShifter shifter;
     float shimSrcL = 0.f, shimSrcR = 0.f;
     float shimPostL = 0.f, shimPostR = 0.f;
 
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>
         smoothedMix, smoothedSize, smoothedDamp, smoothedTone, smoothedShimmer;
+    sc::ParamRamp rampMix, rampSize, rampDamp, rampTone, rampShimmer;
     double sampleRate = 44100.0;
+
+    // Sleeps once input and wet have been silent for a trip round the tank
+    // (0.73 s) and the shimmer buffer; bypassed, the tail rings out through
+    // tailBuffer, fed silence
+    sc::SleepGate sleep;
+    int sleepHold = 0;
+    juce::AudioBuffer<float> tailBuffer;
+
+    // TANK RATE 48k: at 88.2 kHz and up the tank runs at the host rate
+    // halved down to 44.1 / 48 kHz (tankStages halvings), between a
+    // decimation of its mono input and an interpolation of its wet output.
+    // Input waits in decIn until it fills whole frames; wetQueue holds the
+    // wet back at the host rate, tankFactor - 1 samples behind the dry.
+    static constexpr int kMaxTankFactor = 1 << sc::Oversampler::kMaxStages;
+    static_assert(sc::Oversampler::kMaxStages <= sc::EarlyReflections::kMaxHalvings,
+                  "EARLY is laid out for every tank rate");
+    sc::Oversampler resampler;
+    int tankStages = 0;
+    float decIn[sc::kRampChunk + kMaxTankFactor] = {};
+    int decPending = 0;
+    float wetQueue[kMaxWets][sc::kRampChunk + 2 * kMaxTankFactor] = {};
+    int wetQueued = 0;
+
+    // ALGORITHM IR: convolution with a response from disk in place of the
+    // tank. Only loaded while IR is selected. The loader thread reads the
+    // file, resamples it to the tank rate and builds a Convolver, then hands
+    // it over through irIncoming; the engine it replaces comes back through
+    // irRetired to be freed there. The audio thread never waits for the
+    // loader, except in an offline render, for the response it asked for.
+    // An engine is keyed on the irRequest and the tankStages it was built
+    // for; prepareToPlay bumps the request, so a key never outlives the host
+    // rate it was built at.
+    struct IrEngine {
+        std::unique_ptr<sc::Convolver> conv;   // nullptr: no response
+        int    request = 0;
+        int    stages = 0;
+        double rate = 0.0;                     // the tank rate, tankStages halvings down
+    };
+    // Sleeps until notified: of a new file by setImpulseResponse, of a new
+    // tank rate or an engine to free by the audio thread, which only does so
+    // when one of those changes
+    class IrLoader : public juce::Thread {
+    public:
+        explicit IrLoader(DreamverbProcessor& p) : juce::Thread("Dreamverb IR loader"), owner(p) {}
+        ~IrLoader() override { stopThread(4000); }
+        void run() override;
+        bool buildRequested();         // builds and hands over if the request changed
+    private:
+        DreamverbProcessor& owner;
+        int builtRequest = -1, builtStages = -1;
+    };
+    std::unique_ptr<IrEngine> ir;
+    std::atomic<IrEngine*> irIncoming { nullptr }, irRetired { nullptr };
+    std::atomic<int>    irRequest { 0 };
+    std::atomic<int>    irWantedStages { -1 };  // -1 while IR is not selected
+    std::atomic<double> irHostRate { 0.0 };     // set by prepareToPlay with the loader stopped
+    std::atomic<double> irSeconds { 0.0 };      // the response taken, for the reported tail
+    juce::CriticalSection irFileLock;
+    juce::File irFile;
+    juce::WaitableEvent irBuilt;
+    IrLoader irLoader { *this };
+    void takeImpulseResponse();
+
     void initBuffers(double sr);
+    void setTankRate(int stages);
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DreamverbProcessor)
 };
@@ -1,6 +1,8 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "FastMath.h"
 #include <cmath>
+#include <type_traits>
 
 ECHODLYProcessor::ECHODLYProcessor()
     : AudioProcessor(BusesProperties()
@@ -17,18 +19,131 @@ juce::AudioProcessorValueTreeState::ParameterLayout ECHODLYProcessor::createPara
         std::make_unique<juce::AudioParameterFloat>("param6", "TONE",   0.0f, 1.0f,   0.5f),
         std::make_unique<juce::AudioParameterFloat>("damp",   "SUB",    0.0f, 1.0f,   0.5f),
         std::make_unique<juce::AudioParameterFloat>("pre",    "PING",   0.0f, 1.0f,   0.0f),
-        std::make_unique<juce::AudioParameterFloat>("param7", "MOD",    0.0f, 1.0f,   0.15f)
+        std::make_unique<juce::AudioParameterFloat>("param7", "MOD",    0.0f, 1.0f,   0.15f),
+        std::make_unique<juce::AudioParameterChoice>("quality", "QUALITY",
+                                                     juce::StringArray{ "Linear", "Cubic", "Lagrange", "Allpass", "Sinc" }, 1),
+        std::make_unique<juce::AudioParameterChoice>("timemode", "TIME MODE",
+                                                     juce::StringArray{ "Glide", "Jump" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("taps", "TAPS",
+                                                     juce::StringArray{ "Dual", "Quarters", "Spread", "Cloud" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("range", "RANGE",
+                                                     juce::StringArray{ "Normal", "Long" }, 0)
     };
 }
 
+// ── Tap patterns ──
+// Tap k reads both lines at time x TIME + sub x (TIME x SUB), the left
+// read pushed later and the right earlier by its share of the two LFOs.
+// gain and pan (balance, -1 .. 1) place it in the wet mix; send is the
+// part of that which goes back into the lines.
+struct EchoTap {
+    float time, sub, gain, pan, send, modA, modB;
+    float gainL() const { return gain * juce::jmin(1.0f, 1.0f - pan); }
+    float gainR() const { return gain * juce::jmin(1.0f, 1.0f + pan); }
+};
+
+struct TapPattern {
+    int     count;
+    bool    sendsWholeMix;   // every tap sends all it plays: the feedback is the wet mix itself
+    EchoTap taps[ECHODLYProcessor::kMaxTaps];
+};
+
+static constexpr TapPattern kTapPatterns[] = {
+    // Dual: delay 1 at TIME, and delay 2 - which ran TIME x SUB behind
+    // delay 1's output at 0.7 x 0.7 - as a tap at their sum
+    { 2, true, {
+        { 1.0f, 0.0f, 1.00f, 0.0f, 1.0f, 1.0f, 0.0f },
+        { 1.0f, 1.0f, 0.49f, 0.0f, 1.0f, 1.0f, 1.0f },
+    } },
+    // Quarters: a tap on each quarter of TIME, panned around; only the
+    // last feeds back. SUB swings the second.
+    { 4, false, {
+        { 0.25f, 0.0f,   0.45f, -0.7f,  0.0f, 1.0f, 0.0f },
+        { 0.42f, 0.11f,  0.55f,  0.7f,  0.0f, 0.0f, 1.0f },
+        { 0.75f, 0.0f,   0.65f, -0.35f, 0.0f, 1.0f, 0.0f },
+        { 1.0f,  0.0f,   1.00f,  0.0f,  1.0f, 0.0f, 1.0f },
+    } },
+    // Spread: seven taps walking left to right, then TIME in the middle
+    { 8, false, {
+        { 0.250f, 0.0f, 0.35f, -1.00f, 0.1f, 1.0f, 0.0f },
+        { 0.357f, 0.0f, 0.36f, -0.67f, 0.1f, 0.0f, 1.0f },
+        { 0.464f, 0.0f, 0.38f, -0.33f, 0.1f, 1.0f, 0.0f },
+        { 0.571f, 0.0f, 0.39f,  0.00f, 0.1f, 0.0f, 1.0f },
+        { 0.679f, 0.0f, 0.41f,  0.33f, 0.1f, 1.0f, 0.0f },
+        { 0.786f, 0.0f, 0.42f,  0.67f, 0.1f, 0.0f, 1.0f },
+        { 0.893f, 0.0f, 0.44f,  1.00f, 0.1f, 1.0f, 0.0f },
+        { 1.000f, 0.0f, 0.60f,  0.00f, 1.0f, 0.0f, 1.0f },
+    } },
+    // Cloud: sixteen taps at golden-ratio spacing between a quarter and
+    // the whole of TIME, SUB pulling them apart a little
+    { 16, false, {
+        { 0.250f, 0.000f, 0.340f,  0.25f, 0.12f,  1.0f,  0.0f },
+        { 0.714f, 0.046f, 0.266f, -0.82f, 0.12f,  0.0f,  1.0f },
+        { 0.427f, 0.092f, 0.312f,  0.63f, 0.12f, -1.0f,  0.0f },
+        { 0.891f, 0.018f, 0.238f, -0.45f, 0.12f,  0.0f, -1.0f },
+        { 0.604f, 0.063f, 0.283f,  0.26f, 0.12f,  1.0f,  0.0f },
+        { 0.318f, 0.109f, 0.329f, -0.83f, 0.12f,  0.0f,  1.0f },
+        { 0.781f, 0.035f, 0.255f,  0.65f, 0.12f, -1.0f,  0.0f },
+        { 0.495f, 0.081f, 0.301f, -0.46f, 0.12f,  0.0f, -1.0f },
+        { 0.958f, 0.007f, 0.227f,  0.28f, 0.12f,  1.0f,  0.0f },
+        { 0.672f, 0.053f, 0.273f, -0.85f, 0.12f,  0.0f,  1.0f },
+        { 0.385f, 0.098f, 0.318f,  0.66f, 0.12f, -1.0f,  0.0f },
+        { 0.849f, 0.024f, 0.244f, -0.48f, 0.12f,  0.0f, -1.0f },
+        { 0.562f, 0.070f, 0.290f,  0.29f, 0.12f,  1.0f,  0.0f },
+        { 0.276f, 0.116f, 0.336f, -0.86f, 0.12f,  0.0f,  1.0f },
+        { 0.739f, 0.042f, 0.262f,  0.68f, 0.12f, -1.0f,  0.0f },
+        { 0.453f, 0.088f, 0.308f, -0.49f, 0.12f,  0.0f, -1.0f },
+    } },
+};
+constexpr int kNumTapPatterns = (int)(sizeof(kTapPatterns) / sizeof(kTapPatterns[0]));
+
+// Sends are 0 .. 1, so a tap sends all it plays when its send is >= 1
+constexpr bool patternsFlagWholeMix(){
+    for(const auto& p : kTapPatterns){
+        bool all = true;
+        for(int k = 0; k < p.count; k++) all = all && p.taps[k].send >= 1.0f;
+        if(all != p.sendsWholeMix) return false;
+    }
+    return true;
+}
+static_assert(patternsFlagWholeMix(), "a pattern's sendsWholeMix must match its taps' sends");
+
+// The lines hold twice the longest TIME, so Dual's second tap reaches as
+// far as delay 2 used to (delay 1 plus up to a full 1.65 s line). RANGE
+// "Long" stretches TIME to 30 s, and its lines reach as far as any tap can
+// read there: Dual's second, at 30 s x (1 + 1.618), with slack for the LFO
+// swing and a block.
+constexpr double kLineSeconds = 1.65 * 2.0, kLongLineSeconds = 30.0 * (1.0 + 1.618) + 0.05;
+
+// Long lines are paged (see BasicFractionalDelay::initPaged): pages of 2^14
+// samples (64 KB of float32) are reserved for the full length at prepare time,
+// and each block sets the length the taps can reach, so the ring only takes
+// in - and the OS only maps - pages the current TIME needs.
+constexpr int kPageLog2 = 14;
+
 void ECHODLYProcessor::prepareToPlay(double sr, int samplesPerBlock){
     sampleRate = sr;
-    const int maxSamples = (int)(sr * 1.65);
-    delayBufL1.init(maxSamples); delayBufR1.init(maxSamples);
-    delayBufL2.init(maxSamples); delayBufR2.init(maxSamples);
-    lfoPhase = 0.f; lfoPhase2 = 0.13f;
+    const int maxSamples = (int)(sr * kLongLineSeconds);
+    delayBufL.initPaged(maxSamples, kPageLog2); delayBufR.initPaged(maxSamples, kPageLog2);
+    delayBufL.setLength((int)(sr * kLineSeconds)); delayBufR.setLength((int)(sr * kLineSeconds));
+    tapReachSeconds.store(-1.0, std::memory_order_relaxed);
+    sc::interp::prepareSincTable();
+    std::fill(std::begin(allpassHeads), std::end(allpassHeads), sc::interp::Allpass::State{});
+    // Equal-power fade-in gains (the two heads read unrelated stretches of
+    // the line); fade-out reads the table backwards. A chunk of zeros before
+    // and ones after let a fade end part way through a chunk.
+    jumpFadeLength = juce::jmax(1, (int)(sr * 0.02));
+    jumpFade.assign((size_t)(sc::kRampChunk + jumpFadeLength + sc::kRampChunk), 1.0f);
+    for(int k = -sc::kRampChunk; k < jumpFadeLength; k++)
+        jumpFade[(size_t)(sc::kRampChunk + k)] = k < 0 ? 0.0f
+                                               : (float)std::sin(0.5 * juce::MathConstants<double>::pi * k / jumpFadeLength);
+    jump = JumpHeads{};
+    jumpWasOn = false;
+    lfo.setFrequency(0.4 / sr);
+    lfo.setPhase(0.0);
     hiFilterL = hiFilterR = loFilterL = loFilterR = 0.f;
     fbFilterL = fbFilterR = 0.f;
+    sendHiL = sendHiR = sendLoL = sendLoR = 0.f;
 
     smMix.reset(sr, 0.05);      smMix.setCurrentAndTargetValue(0.4f);
     smTime.reset(sr, 0.2);      smTime.setCurrentAndTargetValue(0.35f);
@@ -37,11 +152,129 @@ void ECHODLYProcessor::prepareToPlay(double sr, int samplesPerBlock){
     smSub.reset(sr, 0.2);       smSub.setCurrentAndTargetValue(0.5f);
     smPing.reset(sr, 0.05);     smPing.setCurrentAndTargetValue(0.0f);
     smMod.reset(sr, 0.05);      smMod.setCurrentAndTargetValue(0.15f);
+    sleep.reset();
+    tailBuffer.setSize(2, juce::jmax(samplesPerBlock, sc::kRampChunk));
+}
+
+// Controls derived from the seven smoothed parameters. Built once per chunk
+// on the steady path; while a parameter is ramping, built at control rate
+// and interpolated in between (see forControlSegments).
+struct EchoControls {
+    float mix, feedback, ping, d1, d2, lfoDepth, toneCoef;
+    bool  hiCut;
+
+    static constexpr float kMaxSubRatio = 1.618f;
+
+    static EchoControls make(float mix, float timeParm, float feedback, float tone,
+                             float sub, float ping, float mod, bool longRange, double sampleRate){
+        EchoControls c;
+        c.mix      = mix;
+        c.feedback = juce::jmin(feedback, 0.88f);
+        c.ping     = ping;
+
+        // Delay 1: exponential time mapping 20ms - 1600ms (Long: 20ms - 30s)
+        const float delayMs1 = 20.0f * sc::fastPow(longRange ? sc::kLog2Of1500 : sc::kLog2Of80, timeParm);
+        c.d1 = juce::jmax(1.0f, delayMs1 * 0.001f * (float)sampleRate);
+
+        // Delay 2: subdivision of delay 1 (at most kMaxSubRatio of it)
+        // sub knob maps to musical ratios: 0=triplet(0.667), 0.25=8th(0.5), 0.5=dotted8th(0.75), 0.75=dotted qtr(1.5), 1=golden(1.618)
+        float subRatio;
+        if      (sub < 0.2f)  subRatio = 0.667f;
+        else if (sub < 0.4f)  subRatio = 0.5f;
+        else if (sub < 0.6f)  subRatio = 0.75f;
+        else if (sub < 0.8f)  subRatio = 1.5f;
+        else                  subRatio = kMaxSubRatio;
+        c.d2 = juce::jmax(1.0f, c.d1 * subRatio);
+
+        c.lfoDepth = mod * mod * 12.0f; // quadratic for fine control at low values
+
+        c.hiCut = tone < 0.5f;
+        if(c.hiCut){
+            const float cutoff = 800.0f + tone * 2.0f * 14000.0f; // 800Hz-14800Hz
+            c.toneCoef = 1.0f - (float)(juce::MathConstants<double>::twoPi * cutoff / sampleRate);
+        } else {
+            const float cutoff = (tone - 0.5f) * 2.0f * 400.0f; // 0-400Hz cut
+            c.toneCoef = 1.0f - (float)(juce::MathConstants<double>::twoPi * juce::jmax(20.0f, cutoff) / sampleRate);
+        }
+        return c;
+    }
+
+    // Straight-line blend between two control points. The tone filter
+    // switches between hi- and lo-cut at TONE = 0.5, where its coefficient
+    // means something else, so across the switch it steps at the midpoint.
+    static EchoControls lerp(const EchoControls& a, const EchoControls& b, float t){
+        auto mixf = [t](float x, float y){ return x + (y - x) * t; };
+        EchoControls c;
+        c.mix      = mixf(a.mix, b.mix);
+        c.feedback = mixf(a.feedback, b.feedback);
+        c.ping     = mixf(a.ping, b.ping);
+        c.d1       = mixf(a.d1, b.d1);
+        c.d2       = mixf(a.d2, b.d2);
+        c.lfoDepth = mixf(a.lfoDepth, b.lfoDepth);
+        if(a.hiCut == b.hiCut){ c.hiCut = a.hiCut; c.toneCoef = mixf(a.toneCoef, b.toneCoef); }
+        else                  { c.hiCut = t < 0.5f ? a.hiCut : b.hiCut; c.toneCoef = t < 0.5f ? a.toneCoef : b.toneCoef; }
+        return c;
+    }
+};
+
+// Furthest any tap of pattern reads at a TIME of d1 samples: its longest
+// time plus sub at the widest SUB
+static float tapReach(const TapPattern& pattern, float d1){
+    float reach = 0.0f;
+    for(int k = 0; k < pattern.count; k++)
+        reach = juce::jmax(reach, pattern.taps[k].time + pattern.taps[k].sub * EchoControls::kMaxSubRatio);
+    return reach * d1;
+}
+
+// Until the repeats have died away 60 dB: as far as the taps read in the
+// last block (or, before the first, at TIME's setting), for the first echo
+// and again for every pass FDBK takes to lose it
+double ECHODLYProcessor::getTailLengthSeconds() const {
+    double reach = tapReachSeconds.load(std::memory_order_relaxed);
+    if(reach < 0.0){
+        const bool longRange = *apvts.getRawParameterValue("range") >= 0.5f;
+        const int  pattern   = juce::jlimit(0, kNumTapPatterns - 1, (int)*apvts.getRawParameterValue("taps"));
+        const auto c = EchoControls::make(0.0f, *apvts.getRawParameterValue("size"), 0.0f, 0.5f,
+                                          0.0f, 0.0f, 0.0f, longRange, sampleRate);
+        reach = juce::jmin(tapReach(kTapPatterns[pattern], c.d1) / sampleRate, longRange ? kLongLineSeconds : kLineSeconds);
+    }
+    const double feedback = juce::jlimit(0.0f, 0.88f, apvts.getRawParameterValue("param5")->load());
+    const double trips    = feedback > 0.001 ? std::ceil(std::log(0.001) / std::log(feedback)) : 0.0;
+    return reach * (1.0 + trips);
+}
+
+// Control rate: the delay times and tone coefficient are worked out every
+// kControlInterval samples (16 or 32; a power of two up to kRampChunk) and
+// interpolated in between. The smoothers ramp linearly, so only the
+// curvature of the time / tone mappings is lost, far below a sample of
+// delay.
+constexpr int kControlInterval = 16;
+static_assert(sc::kRampChunk % kControlInterval == 0, "control segments must tile a chunk");
+
+// The second LFO's lead on the first: cos and sin of 0.13 cycle
+constexpr float kLfoBCos = 0.68454711f, kLfoBSin = 0.72896863f;
+
+// TIME MODE "Jump": delay changes smaller than this (in samples) are not
+// worth a crossfade
+constexpr float kJumpMinChange = 0.5f;
+
+// Splits an n-sample chunk into control segments: fn(s, e, stop) covers
+// samples [s, stop), interpolating from the point at s to the one at e.
+// Points sit every kControlInterval samples plus on the chunk's last
+// sample, so no segment needs a value from past the chunk.
+template <class Fn>
+static void forControlSegments(const int n, Fn&& fn){
+    for(int s = 0; s < n; ){
+        const int e    = juce::jmin(s + kControlInterval, n - 1);
+        const int stop = e == n - 1 ? n : e;
+        fn(s, e, stop);
+        s = stop;
+    }
 }
 
 void ECHODLYProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&){
     juce::ScopedNoDenormals noDenormals;
-    if(delayBufL1.capacity == 0){ buffer.clear(); return; }
+    if(delayBufL.size() == 0){ buffer.clear(); return; }
 
     smMix.setTargetValue     (*apvts.getRawParameterValue("mix"));
     smTime.setTargetValue    (*apvts.getRawParameterValue("size"));
@@ -56,75 +289,83 @@ void ECHODLYProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Midi
     auto* L = buffer.getWritePointer(0);
     auto* R = ch > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0);
 
-    // LFO for modulation
-    const float lfoRate = 0.4f / (float)sampleRate;
-
-    for(int i = 0; i < N; i++){
-        const float mix      = smMix.getNextValue();
-        const float timeParm = smTime.getNextValue();
-        const float feedback = juce::jmin(smFeedback.getNextValue(), 0.88f);
-        const float tone     = smTone.getNextValue();
-        const float sub      = smSub.getNextValue();
-        const float ping     = smPing.getNextValue();
-        const float mod      = smMod.getNextValue();
-
-        // Delay 1: exponential time mapping 20ms - 1600ms
-        const float delayMs1 = 20.0f * std::pow(80.0f, timeParm);
-        const float d1 = juce::jmax(1.0f, delayMs1 * 0.001f * (float)sampleRate);
+    // ── Sleep: silent in, nothing left in the lines — only the dry gain ──
+    // The LFO keeps time, so the repeats pick up where they would have
+    const float inPeak = sc::blockPeak(buffer.getArrayOfReadPointers(), juce::jmin(ch, 2), N);
+    if(sleep.sleep(inPeak)){
+        for(auto* sm : { &smMix, &smTime, &smFeedback, &smTone, &smSub, &smPing, &smMod })
+            sm->skip(N);
+        lfo.advance(N);
+        buffer.applyGain(1.0f - smMix.getCurrentValue());
+        return;
+    }
+    float tailPeak = 0.0f;   // taps and sends
 
-        // Delay 2: subdivision of delay 1
-        // sub knob maps to musical ratios: 0=triplet(0.667), 0.25=8th(0.5), 0.5=dotted8th(0.75), 0.75=dotted qtr(1.5), 1=golden(1.618)
-        float subRatio;
-        if      (sub < 0.2f)  subRatio = 0.667f;
-        else if (sub < 0.4f)  subRatio = 0.5f;
-        else if (sub < 0.6f)  subRatio = 0.75f;
-        else if (sub < 0.8f)  subRatio = 1.5f;
-        else                  subRatio = 1.618f;
-        const float d2 = juce::jmax(1.0f, d1 * subRatio);
+    // TAPS: the pattern the lines are read with
+    const int patternIndex = juce::jlimit(0, kNumTapPatterns - 1, (int)*apvts.getRawParameterValue("taps"));
+    if(patternIndex != tapPattern){
+        std::fill(std::begin(allpassHeads), std::end(allpassHeads), sc::interp::Allpass::State{});
+        tapPattern = patternIndex;
+    }
+    const TapPattern& pattern = kTapPatterns[patternIndex];
+    const bool sendsWholeMix = pattern.sendsWholeMix;
+    struct TapGains { float l, r, sendL, sendR; };
+    TapGains gains[kMaxTaps];
+    for(int k = 0; k < pattern.count; k++){
+        const EchoTap& t = pattern.taps[k];
+        gains[k] = { t.gainL(), t.gainR(), t.send * t.gainL(), t.send * t.gainR() };
+    }
 
-        // LFO modulation — subtle chorus on repeats
-        const float lfoDepth = mod * mod * 12.0f; // quadratic for fine control at low values
-        const float lfoA = lfoDepth * std::sin(juce::MathConstants<float>::twoPi * lfoPhase);
-        const float lfoB = lfoDepth * std::sin(juce::MathConstants<float>::twoPi * lfoPhase2);
-        lfoPhase  = std::fmod(lfoPhase  + lfoRate, 1.0f);
-        lfoPhase2 = std::fmod(lfoPhase2 + lfoRate, 1.0f);
+    // wetL / wetR are the taps mixed for this sample, sendL / sendR what they
+    // send back (unused when the pattern sends the whole mix)
+    auto tick = [&](const int i, const EchoControls& c, float wetL, float wetR, float sendL, float sendR){
+        const float mix      = c.mix;
+        const float feedback = c.feedback;
+        const float ping     = c.ping;
 
         const float dry0 = L[i], dry1 = R[i];
 
-        // Read delay lines with modulation
-        float w1L = juce::jlimit(-1.0f, 1.0f, delayBufL1.read(juce::jmax(1.0f, d1 + lfoA)));
-        float w1R = juce::jlimit(-1.0f, 1.0f, delayBufR1.read(juce::jmax(1.0f, d1 - lfoA)));
-        float w2L = juce::jlimit(-1.0f, 1.0f, delayBufL2.read(juce::jmax(1.0f, d2 + lfoB)));
-        float w2R = juce::jlimit(-1.0f, 1.0f, delayBufR2.read(juce::jmax(1.0f, d2 - lfoB)));
-
         // TONE — dual filter on feedback path (like DIG)
         // tone < 0.5: hi-cut (dark warm repeats)
         // tone = 0.5: flat
         // tone > 0.5: lo-cut (bright airy repeats)
-        float toneWetL = w1L + w2L * 0.7f;
-        float toneWetR = w1R + w2R * 0.7f;
+        float toneWetL = wetL;
+        float toneWetR = wetR;
 
-        if(tone < 0.5f){
+        const float coef = c.toneCoef;
+        if(c.hiCut){
             // Hi cut — low pass filter
-            const float cutoff = 800.0f + tone * 2.0f * 14000.0f; // 800Hz-14800Hz
-            const float coef = 1.0f - (float)(juce::MathConstants<double>::twoPi * cutoff / sampleRate);
             hiFilterL = hiFilterL * coef + toneWetL * (1.0f - coef);
             hiFilterR = hiFilterR * coef + toneWetR * (1.0f - coef);
             toneWetL = hiFilterL;
             toneWetR = hiFilterR;
         } else {
             // Lo cut — high pass filter
-            const float cutoff = (tone - 0.5f) * 2.0f * 400.0f; // 0-400Hz cut
-            const float coef = 1.0f - (float)(juce::MathConstants<double>::twoPi * juce::jmax(20.0f, cutoff) / sampleRate);
             loFilterL = loFilterL * coef + toneWetL * (1.0f - coef);
             loFilterR = loFilterR * coef + toneWetR * (1.0f - coef);
             toneWetL = toneWetL - loFilterL;
             toneWetR = toneWetR - loFilterR;
         }
 
+        // The sends go through the same filter when they differ from the mix
+        float fbInL = toneWetL, fbInR = toneWetR;
+        if(!sendsWholeMix){
+            if(c.hiCut){
+                sendHiL = sendHiL * coef + sendL * (1.0f - coef);
+                sendHiR = sendHiR * coef + sendR * (1.0f - coef);
+                fbInL = sendHiL;
+                fbInR = sendHiR;
+            } else {
+                sendLoL = sendLoL * coef + sendL * (1.0f - coef);
+                sendLoR = sendLoR * coef + sendR * (1.0f - coef);
+                fbInL = sendL - sendLoL;
+                fbInR = sendR - sendLoR;
+            }
+        }
+
         // Feedback path with safety clamp
-        float fb0 = juce::jlimit(-0.9f, 0.9f, toneWetL * feedback);
-        float fb1 = juce::jlimit(-0.9f, 0.9f, toneWetR * feedback);
+        float fb0 = juce::jlimit(-0.9f, 0.9f, fbInL * feedback);
+        float fb1 = juce::jlimit(-0.9f, 0.9f, fbInR * feedback);
 
         // PING PONG routing
         // ping=0: parallel (L feeds L, R feeds R)
@@ -132,17 +373,262 @@ void ECHODLYProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Midi
         float feedL = fb0 + ping * (fb1 - fb0);
         float feedR = fb1 + ping * (fb0 - fb1);
 
-        // Write to delay lines
-        // Delay 1: direct input + feedback
-        delayBufL1.push(dry0 + feedL);
-        delayBufR1.push(dry1 + feedR);
-        // Delay 2: feeds from delay 1 output (series routing)
-        delayBufL2.push(w1L * 0.7f);
-        delayBufR2.push(w1R * 0.7f);
+        // Write to delay lines: input + feedback
+        delayBufL.push(dry0 + feedL);
+        delayBufR.push(dry1 + feedR);
 
         // Final output
         L[i] = (1.0f - mix) * dry0 + mix * toneWetL;
         R[i] = (1.0f - mix) * dry1 + mix * toneWetR;
+    };
+
+    // TIME MODE "Jump": rather than following TIME and SUB sample by sample,
+    // the taps read at held delays. A change starts a crossfade to a second
+    // set of heads at the new delays, the only time two sets of reads run.
+    const bool jumpMode  = *apvts.getRawParameterValue("timemode") >= 0.5f;
+    const bool longRange = *apvts.getRawParameterValue("range") >= 0.5f;
+    if(jumpMode){
+        // Coming from Glide: the heads start where the taps are reading now
+        if(!jumpWasOn){
+            const auto c = EchoControls::make(0.0f, smTime.getCurrentValue(), 0.0f, 0.5f,
+                                              smSub.getCurrentValue(), 0.0f, 0.0f, longRange, sampleRate);
+            jump = JumpHeads{};
+            jump.d1 = c.d1; jump.d2 = c.d2;
+        }
+        // The crossfade does the smoothing, so TIME and SUB go straight to
+        // their targets and automating them leaves the chunks steady
+        smTime.setCurrentAndTargetValue(smTime.getTargetValue());
+        smSub.setCurrentAndTargetValue(smSub.getTargetValue());
+    }
+    jumpWasOn = jumpMode;
+
+    // As far as the taps can read this block: the longest TIME among the
+    // smoother's ends and the Jump heads, at the widest SUB. RANGE "Long"
+    // sizes the lines to it plus the LFO swing and a chunk of slack; Normal
+    // keeps the full 3.3 s. The tail reported to the host follows it.
+    float d1 = jumpMode ? juce::jmax(jump.d1, jump.nextD1) : 0.0f;
+    for(const float t : { smTime.getCurrentValue(), smTime.getTargetValue() })
+        d1 = juce::jmax(d1, EchoControls::make(0.0f, t, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f, longRange, sampleRate).d1);
+    const float reach = tapReach(pattern, d1);
+    const int lineLength = longRange ? (int)reach + 2 * (12 + sc::kRampChunk) : (int)(sampleRate * kLineSeconds);
+    delayBufL.setLength(lineLength); delayBufR.setLength(lineLength);
+    tapReachSeconds.store(juce::jmin((double)reach, (double)lineLength) / sampleRate, std::memory_order_relaxed);
+
+    // One chunk: the taps are read, crossfaded in Jump, clipped and mixed,
+    // then the chunk runs through tick. The shortest tap (a quarter of
+    // 20 ms) is normally longer than a chunk, so the reads come straight out
+    // of the lines as blocks before any of the chunk is written back;
+    // otherwise every tap is read as its sample runs.
+    // K is the QUALITY interpolation kernel; ctl(i) returns the controls for
+    // sample i; fixed means the delay times hold still for the whole chunk
+    // (steady controls, MOD at zero).
+    auto runChunk = [&](auto kernel, const int start, const int n, const bool fixed, auto&& ctl){
+        using K = decltype(kernel);
+
+        // LFO modulation — subtle chorus on repeats. B is A a little over
+        // an eighth of a cycle on, turned from the same phasor.
+        float lfoA[sc::kRampChunk], lfoB[sc::kRampChunk], lfoCos[sc::kRampChunk];
+        float lfoPeakA = 0.0f, lfoPeakB = 0.0f;
+        lfo.fill(lfoA, lfoCos, n);
+        for(int i = 0; i < n; i++){
+            const float depth = ctl(i).lfoDepth;
+            lfoB[i] = depth * (lfoA[i] * kLfoBCos + lfoCos[i] * kLfoBSin);
+            lfoA[i] = depth * lfoA[i];
+            lfoPeakA = juce::jmax(lfoPeakA, std::abs(lfoA[i]));
+            lfoPeakB = juce::jmax(lfoPeakB, std::abs(lfoB[i]));
+        }
+
+        // Jump: pick up a TIME / SUB change once the last crossfade is done
+        if(jumpMode && !jump.fading()){
+            const EchoControls& c = ctl(n - 1);
+            if(std::abs(c.d1 - jump.d1) >= kJumpMinChange || std::abs(c.d2 - jump.d2) >= kJumpMinChange){
+                jump.nextD1 = c.d1; jump.nextD2 = c.d2;
+                jump.pos = 0;
+                std::fill(allpassHeads + kHeadStates, allpassHeads + 2 * kHeadStates, sc::interp::Allpass::State{});
+            }
+        }
+        const bool fading = jumpMode && jump.fading();
+        const int  heads  = fading ? 2 : 1;
+
+        // TIME and TIME x SUB delays per head, and their lowest in the chunk
+        float d1s[2][sc::kRampChunk], d2s[2][sc::kRampChunk];
+        float low1[2], low2[2];
+        auto fillHead = [&](const int h, auto&& d1Of, auto&& d2Of){
+            low1[h] = low2[h] = (float)delayBufL.size();
+            for(int i = 0; i < n; i++){
+                d1s[h][i] = d1Of(i);
+                d2s[h][i] = d2Of(i);
+                low1[h] = juce::jmin(low1[h], d1s[h][i]);
+                low2[h] = juce::jmin(low2[h], d2s[h][i]);
+            }
+        };
+        if(!jumpMode)
+            fillHead(0, [&](int i){ return ctl(i).d1; }, [&](int i){ return ctl(i).d2; });
+        else
+            fillHead(0, [&](int){ return jump.d1; }, [&](int){ return jump.d2; });
+        if(fading)
+            fillHead(1, [&](int){ return jump.nextD1; }, [&](int){ return jump.nextD2; });
+
+        auto tapDelay = [&](const EchoTap& t, const int h, const int i){ return t.time * d1s[h][i] + t.sub * d2s[h][i]; };
+        auto tapMod   = [&](const EchoTap& t, const int i){ return t.modA * lfoA[i] + t.modB * lfoB[i]; };
+
+        // The nearest any tap reads this chunk, from the lowest delays and
+        // the LFO swing
+        float minDelay = (float)delayBufL.size();
+        for(int k = 0; k < pattern.count; k++){
+            const EchoTap& t = pattern.taps[k];
+            for(int h = 0; h < heads; h++)
+                minDelay = juce::jmin(minDelay, t.time * low1[h] + t.sub * low2[h]
+                                                - std::abs(t.modA) * lfoPeakA - std::abs(t.modB) * lfoPeakB);
+        }
+        const bool ahead = delayBufL.canReadAhead<K>(juce::jmax(1.0f, minDelay), n);
+
+        // One kernel state per read (tap, side, head); only the allpass keeps any
+        typename K::State scratch[2 * kHeadStates];
+        typename K::State* st = scratch;
+        if constexpr (std::is_same_v<K, sc::interp::Allpass>) st = allpassHeads;
+        auto state = [&](const int h, const int k, const int side) -> typename K::State& {
+            return st[h * kHeadStates + k * 2 + side];
+        };
+
+        // Jump crossfade gains: sample i fades in with gIn[i] and out with gOut[-i]
+        const float* gIn  = jumpFade.data() + sc::kRampChunk + (fading ? jump.pos : 0);
+        const float* gOut = jumpFade.data() + sc::kRampChunk + (fading ? jumpFadeLength - jump.pos : 0);
+
+        float wet[2][sc::kRampChunk], send[2][sc::kRampChunk];
+        auto mixIn = [&](const int k, const int i, const float yL, const float yR){
+            const float l = juce::jlimit(-1.0f, 1.0f, yL), r = juce::jlimit(-1.0f, 1.0f, yR);
+            wet[0][i] += gains[k].l * l;
+            wet[1][i] += gains[k].r * r;
+            if(!sendsWholeMix){
+                send[0][i] += gains[k].sendL * l;
+                send[1][i] += gains[k].sendR * r;
+            }
+        };
+
+        if(ahead){
+            std::fill(wet[0], wet[0] + n, 0.0f);  std::fill(wet[1], wet[1] + n, 0.0f);
+            std::fill(send[0], send[0] + n, 0.0f); std::fill(send[1], send[1] + n, 0.0f);
+            for(int k = 0; k < pattern.count; k++){
+                const EchoTap& t = pattern.taps[k];
+                float y[2][2][sc::kRampChunk];   // head, side
+                for(int h = 0; h < heads; h++){
+                    if(fixed){
+                        const float d = juce::jmax(1.0f, tapDelay(t, h, 0));
+                        delayBufL.read<K>(d, y[h][0], n, state(h, k, 0));
+                        delayBufR.read<K>(d, y[h][1], n, state(h, k, 1));
+                    } else {
+                        float dL[sc::kRampChunk], dR[sc::kRampChunk];
+                        for(int i = 0; i < n; i++){
+                            const float d = tapDelay(t, h, i), m = tapMod(t, i);
+                            dL[i] = juce::jmax(1.0f, d + m);
+                            dR[i] = juce::jmax(1.0f, d - m);
+                        }
+                        delayBufL.read<K>(dL, y[h][0], n, state(h, k, 0));
+                        delayBufR.read<K>(dR, y[h][1], n, state(h, k, 1));
+                    }
+                }
+                if(fading)
+                    for(int side = 0; side < 2; side++)
+                        for(int i = 0; i < n; i++)
+                            y[0][side][i] = y[0][side][i] * gOut[-i] + y[1][side][i] * gIn[i];
+                for(int i = 0; i < n; i++)
+                    mixIn(k, i, y[0][0][i], y[0][1][i]);
+            }
+        }
+
+        for(int i = 0; i < n; i++){
+            if(!ahead){
+                wet[0][i] = wet[1][i] = send[0][i] = send[1][i] = 0.0f;
+                for(int k = 0; k < pattern.count; k++){
+                    const EchoTap& t = pattern.taps[k];
+                    float yL[2], yR[2];
+                    for(int h = 0; h < heads; h++){
+                        const float d = tapDelay(t, h, i), m = tapMod(t, i);
+                        yL[h] = delayBufL.read<K>(juce::jmax(1.0f, d + m), state(h, k, 0));
+                        yR[h] = delayBufR.read<K>(juce::jmax(1.0f, d - m), state(h, k, 1));
+                    }
+                    if(fading){
+                        yL[0] = yL[0] * gOut[-i] + yL[1] * gIn[i];
+                        yR[0] = yR[0] * gOut[-i] + yR[1] * gIn[i];
+                    }
+                    mixIn(k, i, yL[0], yR[0]);
+                }
+            }
+            tick(start + i, ctl(i), wet[0][i], wet[1][i], send[0][i], send[1][i]);
+        }
+        tailPeak = juce::jmax(tailPeak, sc::blockPeak(wet[0], n), sc::blockPeak(wet[1], n));
+        if(!sendsWholeMix)
+            tailPeak = juce::jmax(tailPeak, sc::blockPeak(send[0], n), sc::blockPeak(send[1], n));
+
+        if(fading && (jump.pos += n) >= jumpFadeLength){
+            jump.d1 = jump.nextD1; jump.d2 = jump.nextD2;
+            jump.pos = JumpHeads::kIdle;
+            std::copy(allpassHeads + kHeadStates, allpassHeads + 2 * kHeadStates, allpassHeads);
+        }
+    };
+
+    // Steady parameters (the usual case) run a loop with the controls
+    // hoisted; only chunks where a smoother is moving rebuild them per sample.
+    static_assert(sc::kRampChunk <= DelayLine::kMaxBlock, "chunks must fit one block read");
+    auto runBlock = [&](auto kernel){
+        for(int start = 0; start < N; start += sc::kRampChunk){
+            const int n = juce::jmin(sc::kRampChunk, N - start);
+            rampMix.fill(smMix, n);           rampTime.fill(smTime, n);
+            rampFeedback.fill(smFeedback, n); rampTone.fill(smTone, n);
+            rampSub.fill(smSub, n);           rampPing.fill(smPing, n);
+            rampMod.fill(smMod, n);
+
+            if(sc::anyMoving(rampMix, rampTime, rampFeedback, rampTone, rampSub, rampPing, rampMod)){
+                auto makeAt = [&](int i){
+                    return EchoControls::make(rampMix[i], rampTime[i], rampFeedback[i], rampTone[i],
+                                              rampSub[i], rampPing[i], rampMod[i], longRange, sampleRate);
+                };
+                EchoControls ctl[sc::kRampChunk];
+                EchoControls from = makeAt(0);
+                forControlSegments(n, [&](const int s, const int e, const int stop){
+                    const EchoControls to = makeAt(e);
+                    const float step = e > s ? 1.0f / (float)(e - s) : 0.0f;
+                    for(int i = s; i < stop; i++)
+                        ctl[i] = EchoControls::lerp(from, to, (float)(i - s) * step);
+                    from = to;
+                });
+                runChunk(kernel, start, n, false, [&](int i) -> const EchoControls& { return ctl[i]; });
+            } else {
+                const auto c = EchoControls::make(rampMix.steady, rampTime.steady, rampFeedback.steady, rampTone.steady,
+                                                  rampSub.steady, rampPing.steady, rampMod.steady, longRange, sampleRate);
+                runChunk(kernel, start, n, c.lfoDepth <= 0.0f, [&](int) -> const EchoControls& { return c; });
+            }
+        }
+    };
+
+    // QUALITY picks the delay-read kernel once per block
+    const int quality = (int)*apvts.getRawParameterValue("quality");
+    if(quality != readKernel){
+        std::fill(std::begin(allpassHeads), std::end(allpassHeads), sc::interp::Allpass::State{});
+        readKernel = quality;
+    }
+    switch(quality){
+        case 0:  runBlock(sc::interp::Linear{});   break;
+        case 2:  runBlock(sc::interp::Lagrange{}); break;
+        case 3:  runBlock(sc::interp::Allpass{});  break;
+        case 4:  runBlock(sc::interp::Sinc8{});    break;
+        default: runBlock(sc::interp::Hermite{});  break;
+    }
+    sleep.update(inPeak, tailPeak, N, delayBufL.capacity());
+}
+
+// Bypassed, the dry signal passes untouched and the lines, fed silence,
+// keep repeating on top of it until they sleep
+void ECHODLYProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi){
+    const int N = buffer.getNumSamples(), ch = juce::jmin(buffer.getNumChannels(), 2);
+    for(int start = 0; start < N && !sleep.asleep(); start += tailBuffer.getNumSamples()){
+        const int n = juce::jmin(tailBuffer.getNumSamples(), N - start);
+        juce::AudioBuffer<float> tail(tailBuffer.getArrayOfWritePointers(), 2, n);
+        tail.clear();
+        processBlock(tail, midi);
+        for(int c = 0; c < ch; c++)
+            buffer.addFrom(c, start, tail.getReadPointer(c), n);
     }
 }
 
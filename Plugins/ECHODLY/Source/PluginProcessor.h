@@ -1,8 +1,13 @@
 #pragma once
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
-#include <vector>
+#include "FractionalDelay.h"
+#include "ParamRamp.h"
+#include "QuadratureOsc.h"
+#include "SleepGate.h"
+#include <atomic>
 #include <cmath>
+#include <vector>
 
 class ECHODLYProcessor : public juce::AudioProcessor {
 public:
@@ -11,12 +16,13 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override {}
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
     const juce::String getName() const override { return "ECHODLY"; }
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
-    double getTailLengthSeconds() const override { return 4.0; }
+    double getTailLengthSeconds() const override;
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
     void setCurrentProgram(int) override {}
@@ -26,27 +32,54 @@ public:
     void setStateInformation(const void*, int) override;
     juce::AudioProcessorValueTreeState apvts;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParams();
+    static constexpr int kMaxTaps = 16;   // per TAPS pattern
 private:
-    struct RingBuffer {
-        std::vector<float> buf;
-        int writePos = 0, capacity = 0;
-        void init(int n){ capacity=n; buf.assign(n,0.f); writePos=0; }
-        void push(float v){ buf[writePos]=v; writePos=(writePos+1)%capacity; }
-        float read(float d) const {
-            float ds=juce::jmin(d,(float)(capacity-2));
-            int idx=(int)ds; float frac=ds-idx;
-            auto get=[&](int o){ return buf[(writePos-1-idx+o+capacity*4)%capacity]; };
-            float y0=get(-1),y1=get(0),y2=get(1),y3=get(2);
-            float c0=y1,c1=.5f*(y2-y0),c2=y0-2.5f*y1+2.f*y2-.5f*y3,c3=.5f*(y3-y0)+1.5f*(y1-y2);
-            return ((c3*frac+c2)*frac+c1)*frac+c0;
-        }
+    // One line per channel; every tap of the TAPS pattern reads from it.
+    // The sample format is the ECHODLY_DELAY_STORAGE CMake option: Float
+    // (default), Half or Int16, the last two at half the memory.
+#if defined(ECHODLY_DELAY_STORAGE_Half)
+    using DelayLine = sc::BasicFractionalDelay<sc::store::Half>;
+#elif defined(ECHODLY_DELAY_STORAGE_Int16)
+    using DelayLine = sc::BasicFractionalDelay<sc::store::Int16>;
+#else
+    using DelayLine = sc::BasicFractionalDelay<sc::store::Float32>;
+#endif
+    DelayLine delayBufL, delayBufR;
+    int tapPattern = 0;
+    // QUALITY kernel last used, and the allpass kernel's state for each
+    // tap's two reads; the second half is for the heads TIME MODE "Jump"
+    // fades in to
+    int readKernel = 1;
+    static constexpr int kHeadStates = kMaxTaps * 2;
+    sc::interp::Allpass::State allpassHeads[2 * kHeadStates];
+    // TIME MODE "Jump": the taps sit at held TIME / SUB delays d1 / d2;
+    // while a change is fading in, a second set of heads reads from
+    // nextD1 / nextD2, pos samples in
+    struct JumpHeads {
+        static constexpr int kIdle = -1;
+        float d1 = 0.f, d2 = 0.f, nextD1 = 0.f, nextD2 = 0.f;
+        int   pos = kIdle;
+        bool  fading() const { return pos != kIdle; }
     };
-    RingBuffer delayBufL1, delayBufR1, delayBufL2, delayBufR2;
-    float lfoPhase=0.f, lfoPhase2=0.f;
+    JumpHeads jump;
+    int  jumpFadeLength = 1;   // 20 ms
+    std::vector<float> jumpFade;
+    bool jumpWasOn = false;
+    sc::QuadratureOsc lfo;   // 0.4 Hz MOD LFO
     float hiFilterL=0.f, hiFilterR=0.f;
     float loFilterL=0.f, loFilterR=0.f;
     float fbFilterL=0.f, fbFilterR=0.f;
+    float sendHiL=0.f, sendHiR=0.f, sendLoL=0.f, sendLoR=0.f;   // TONE on the tap sends
     juce::SmoothedValue<float,juce::ValueSmoothingTypes::Linear> smMix,smTime,smFeedback,smTone,smSub,smPing,smMod;
+    sc::ParamRamp rampMix,rampTime,rampFeedback,rampTone,rampSub,rampPing,rampMod;
     double sampleRate=44100.0;
+    // Longest delay the taps read in the last block, for the reported tail;
+    // negative until the first block after prepareToPlay
+    std::atomic<double> tapReachSeconds{0.0};
+    // Sleeps once input and taps have been silent for all the history the
+    // lines hold; bypassed, the repeats ring out through tailBuffer, fed
+    // silence
+    sc::SleepGate sleep;
+    juce::AudioBuffer<float> tailBuffer;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ECHODLYProcessor)
 };
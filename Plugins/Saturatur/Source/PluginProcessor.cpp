@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "FastMath.h"
 #include <cmath>
 
 SaturaturProcessor::SaturaturProcessor()
@@ -9,6 +10,18 @@ SaturaturProcessor::SaturaturProcessor()
       apvts(*this, nullptr, "Parameters", createParams())
 {}
 
+// Same layout in and out: mono, stereo or any of the surround sets up to 7.1
+bool SaturaturProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
+    const auto out = layouts.getMainOutputChannelSet();
+    if(out != layouts.getMainInputChannelSet()) return false;
+    using Set = juce::AudioChannelSet;
+    for(const auto& set : { Set::mono(), Set::stereo(), Set::createLCR(), Set::createLCRS(), Set::quadraphonic(),
+                            Set::create5point0(), Set::create5point1(), Set::create6point0(), Set::create6point1(),
+                            Set::create7point0(), Set::create7point1(), Set::create7point0SDDS(), Set::create7point1SDDS() })
+        if(out == set) return true;
+    return false;
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout SaturaturProcessor::createParams(){
     return {
         std::make_unique<juce::AudioParameterFloat>("bias",   "GRIT",   0.0f, 1.0f, 0.3f),
@@ -19,7 +32,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout SaturaturProcessor::createPa
         std::make_unique<juce::AudioParameterFloat>("mix",    "MIX",    0.0f, 1.0f, 0.8f),
         std::make_unique<juce::AudioParameterFloat>("drive",  "DRIVE",  0.0f, 1.0f, 0.35f),
         std::make_unique<juce::AudioParameterFloat>("type",   "TYPE",   0.0f, 1.0f, 0.0f),
-        std::make_unique<juce::AudioParameterFloat>("param9", "COMP",   0.0f, 1.0f, 0.2f)
+        std::make_unique<juce::AudioParameterFloat>("param9", "COMP",   0.0f, 1.0f, 0.2f),
+        std::make_unique<juce::AudioParameterChoice>("oversampling", "OVERSAMPLING",
+                                                     juce::StringArray{ "Off", "2x", "4x", "8x" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("osfilter", "OS FILTER",
+                                                     juce::StringArray{ "Min Phase", "Linear Phase" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("antialias", "ANTI-ALIAS",
+                                                     juce::StringArray{ "Off", "ADAA 1st", "ADAA 2nd" }, 0),
+        std::make_unique<juce::AudioParameterChoice>("shaperlut", "SHAPER LUT",
+                                                     juce::StringArray{ "Off", "Small", "Medium", "Large" }, 2)
     };
 }
 
@@ -28,7 +49,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout SaturaturProcessor::createPa
 // TAPE — warm tanh, grit adds odd harmonics via polynomial
 float SaturaturProcessor::saturateTape(float x, float drive, float grit){
     const float g = 1.0f + drive * 8.0f;
-    float s = std::tanh(x * g) / std::tanh(g);
+    float s = sc::fastTanh(x * g) / sc::fastTanh(g);
     // Grit: adds odd-order harmonic content (increased from 0.3f to 0.8f)
     if(grit > 0.0f)
         s += grit * 0.8f * (s*s*s - s);
@@ -39,11 +60,10 @@ float SaturaturProcessor::saturateTape(float x, float drive, float grit){
 float SaturaturProcessor::saturateTube(float x, float drive, float grit){
     const float g = 1.0f + drive * 6.0f;
     // Asymmetric waveshaper — different curves per half
-    float s;
-    if(x >= 0.0f)
-        s = 1.0f - std::exp(-x * g);
-    else
-        s = -(1.0f - std::exp(x * g * 0.7f)) * 1.1f;
+    // (both halves share one exp so the select stays branchless)
+    const bool  pos = x >= 0.0f;
+    const float e   = sc::fastExp(-std::abs(x) * (pos ? g : g * 0.7f));
+    float s = pos ? 1.0f - e : -(1.0f - e) * 1.1f;
     // Grit adds presence via 2nd+3rd harmonics (increased from 0.2f to 0.6f)
     s += grit * 0.6f * s * s * (1.0f - std::abs(s));
     return juce::jlimit(-1.0f, 1.0f, s);
@@ -54,8 +74,10 @@ float SaturaturProcessor::saturateClip(float x, float drive, float grit){
     const float g    = 1.0f + drive * 12.0f;
     const float knee = 0.85f - grit * 0.3f; // grit tightens the knee
     float driven = x * g;
-    if     (driven >  knee) driven =  knee + (1.0f - knee) * std::tanh((driven - knee) * (3.0f + grit * 5.0f));
-    else if(driven < -knee) driven = -knee - (1.0f - knee) * std::tanh((-driven - knee) * (3.0f + grit * 5.0f));
+    // Soft knee above |driven| > knee, mirrored for negative input
+    const float over = std::abs(driven) - knee;
+    const float bent = std::copysign(knee + (1.0f - knee) * sc::fastTanh(over * (3.0f + grit * 5.0f)), driven);
+    driven = over > 0.0f ? bent : driven;
     return juce::jlimit(-1.0f, 1.0f, driven * (1.0f / (knee + 0.15f)));
 }
 
@@ -72,11 +94,379 @@ float SaturaturProcessor::saturateFold(float x, float drive, float grit){
     return driven * 0.8f;
 }
 
+// ── ADAA (antiderivative anti-aliasing) ───────────────────────────
+// Each shaper is rewritten as a curve of the driven input u = g * x. The
+// drive gain is then just part of the input signal, so the antiderivative
+// history stays valid while the attack envelope moves the drive around.
+// F1 / F2 are the first / second antiderivatives, zero at u = 0.
+
+namespace {
+// TAPE: s = T tanh(u), T = 1 / tanh(g); with grit weight a the curve is
+// T (1 - a) tanh u + a T^3 tanh^3 u — a grit-free basis of two curves:
+//   ∫tanh   = ln cosh            ∫∫tanh   = G
+//   ∫tanh^3 = ln cosh - tanh^2/2 ∫∫tanh^3 = G - (u - tanh u) / 2
+inline double tanhFast(double u){ return sc::fastTanh((float)u); }
+inline double tanhCubed(double u){ const double t = tanhFast(u); return t * t * t; }
+inline double tanhCubedF1(double u){ const double t = std::tanh(u); return sc::logCosh(u) - 0.5 * t * t; }
+
+// FOLD: 0.8 * triangle wave (period 4) out to |u| = 9, where the four
+// folds run out and it continues as |u| - 8. F1 is even, F2 odd.
+inline double foldF(double u){
+    const double a = std::abs(u);
+    const double p = std::fmod(a + 1.0, 4.0);
+    const double y = a > 9.0 ? a - 8.0 : 1.0 - std::abs(p - 2.0);
+    return u < 0.0 ? -0.8 * y : 0.8 * y;
+}
+inline double foldF1(double u){
+    const double a = std::abs(u);
+    if(a > 9.0) return 0.8 * 0.5 * (a - 8.0) * (a - 8.0);
+    const double p = std::fmod(a + 1.0, 4.0);
+    return 0.8 * ((p <= 2.0 ? 0.5 * p * p - p : 3.0 * p - 0.5 * p * p - 4.0) + 0.5);
+}
+inline double foldF2(double u){
+    const double a = std::abs(u);
+    double y;
+    if(a > 9.0){
+        y = 4.0 + (a - 8.0) * (a - 8.0) * (a - 8.0) / 6.0;
+    } else {
+        const double p = std::fmod(a + 1.0, 4.0);
+        y = 0.5 * a + 1.0 / 3.0 + (p <= 2.0 ? p * p * p / 6.0 - 0.5 * p * p
+                                           : 1.5 * p * p - p * p * p / 6.0 - 4.0 * p + 8.0 / 3.0);
+    }
+    return u < 0.0 ? -0.8 * y : 0.8 * y;
+}
+} // namespace
+
+// TUBE: u >= 0: s = 1 - v, v = e^-u;  u < 0: s = -1.1 (1 - w), w = e^0.7u.
+// With grit b = 0.6 grit, h = s + b s^2 (1 - |s|) is a cubic in v (or w),
+// and ∫v^k du = -v^k / k, ∫w^k du = w^k / 0.7k, so both integrals are
+// closed form. The negative half clamps at -1 below uClamp.
+void SaturaturProcessor::TubeCurve::make(float grit){
+    b = 0.6 * grit;
+    n[0] = -1.1 - 0.121 * b;
+    n[1] =  1.1 + 1.573 * b;
+    n[2] = -2.783 * b;
+    n[3] =  1.331 * b;
+    // h(w) is increasing on (0, 1] with h(0) < -1 < h(1) = 0: bisect for -1
+    double lo = 0.0, hi = 1.0;
+    for(int i = 0; i < 48; i++){
+        const double w = 0.5 * (lo + hi);
+        (n[0] + w * (n[1] + w * (n[2] + w * n[3])) < -1.0 ? lo : hi) = w;
+    }
+    uClamp = std::log(0.5 * (lo + hi)) / 0.7;
+    F1c = 0.0; F2c = 0.0;
+    F1c = F1(uClamp);
+    F2c = F2(uClamp);
+}
+double SaturaturProcessor::TubeCurve::f(double u) const {
+    if(u >= 0.0){
+        const double s = 1.0 - std::exp(-u);
+        return s + b * s * s * (1.0 - s);
+    }
+    const double s = -1.1 * (1.0 - std::exp(0.7 * u));
+    return std::max(s + b * s * s * (1.0 + s), -1.0);
+}
+double SaturaturProcessor::TubeCurve::F1(double u) const {
+    if(u >= 0.0){
+        const double v = std::exp(-u);
+        return u - (b - 1.0) * v + b * v * v - b / 3.0 * v * v * v + b / 3.0 - 1.0;
+    }
+    if(u < uClamp) return F1c - (u - uClamp);
+    const double w = std::exp(0.7 * u);
+    return n[0] * u + n[1] * (w - 1.0) / 0.7 + n[2] * (w * w - 1.0) / 1.4 + n[3] * (w * w * w - 1.0) / 2.1;
+}
+double SaturaturProcessor::TubeCurve::F2(double u) const {
+    if(u >= 0.0){
+        const double v = std::exp(-u);
+        return 0.5 * u * u + (b - 1.0) * v - 0.5 * b * v * v + b / 9.0 * v * v * v
+             + (b / 3.0 - 1.0) * u + 1.0 - 11.0 * b / 18.0;
+    }
+    if(u < uClamp){
+        const double t = u - uClamp;
+        return F2c + F1c * t - 0.5 * t * t;
+    }
+    const double w = std::exp(0.7 * u);
+    return 0.5 * n[0] * u * u
+         + n[1] * ((w - 1.0)         / 0.49 - u / 0.7)
+         + n[2] * ((w * w - 1.0)     / 1.96 - u / 1.4)
+         + n[3] * ((w * w * w - 1.0) / 4.41 - u / 2.1);
+}
+
+// CLIP: linear to the knee, tanh-shaped above it, scaled by sigma and
+// clamped at 1 from uClamp on (never, when grit is 0). Odd, so F1 is even
+// and F2 odd; each region adds on to the integral at its start.
+void SaturaturProcessor::ClipCurve::make(float grit){
+    knee  = 0.85 - 0.3 * grit;
+    k     = 3.0 + 5.0 * grit;
+    sigma = 1.0 / (knee + 0.15);
+    const double r = 0.15 / (1.0 - knee);
+    F1k = sigma * knee * knee * 0.5;
+    F2k = sigma * knee * knee * knee / 6.0;
+    F1c = 0.0; F2c = 0.0;
+    uClamp = 1.0e30;
+    if(r < 1.0){
+        // Integrate up to the clamp point through the knee branch, before
+        // it becomes the boundary F1 / F2 switch to the flat part at
+        const double c = knee + std::atanh(r) / k;
+        F1c = F1(c); F2c = F2(c);
+        uClamp = c;
+    }
+}
+double SaturaturProcessor::ClipCurve::f(double u) const {
+    const double a = std::abs(u);
+    const double p = a <= knee ? a : knee + (1.0 - knee) * std::tanh(k * (a - knee));
+    return std::copysign(std::min(sigma * p, 1.0), u);
+}
+double SaturaturProcessor::ClipCurve::F1(double u) const {
+    const double a = std::abs(u);
+    if(a <= knee)   return sigma * a * a * 0.5;
+    if(a >= uClamp) return F1c + (a - uClamp);
+    const double t = a - knee;
+    return F1k + sigma * (knee * t + (1.0 - knee) / k * sc::logCosh(k * t));
+}
+double SaturaturProcessor::ClipCurve::F2(double u) const {
+    const double a = std::abs(u);
+    double y;
+    if(a <= knee){
+        y = sigma * a * a * a / 6.0;
+    } else if(a >= uClamp){
+        const double t = a - uClamp;
+        y = F2c + F1c * t + 0.5 * t * t;
+    } else {
+        const double t = a - knee;
+        y = F2k + F1k * t + sigma * (0.5 * knee * t * t + (1.0 - knee) / (k * k) * sc::logCoshIntegral(k * t));
+    }
+    return std::copysign(y, u);
+}
+
+// One sample of the ti / ti+1 crossfade through the antialiased shapers.
+// Only shapers with a non-zero weight run; one that was idle on the
+// previous sample restarts its history from this input (its crossfade
+// weight is ~0 when that happens). Tube and clip use the curves processBlock
+// made for this chunk's grit; tape and fold take grit per sample.
+//
+// The antiderivatives stay in double: they are differenced over tiny steps,
+// and taking just e^-2|u| from sc::fastExp leaves the error only 23 dB under
+// a -40 dB 100 Hz sine at 192 kHz. Only the midpoint fallbacks, which are
+// used undifferenced, go through sc::fastTanh.
+float SaturaturProcessor::shapeAntialiased(AdaaState& st, float xIn, float drive, float grit, int ti, float tf){
+    const unsigned liveNow = (tf < 1.0f ? 1u << ti : 0u) | (tf > 0.0f ? 1u << (ti + 1) : 0u);
+    const bool regrit = !sc::sameBits(st.grit, curveGrit);
+    st.grit = curveGrit;
+    const double x = xIn;
+
+    auto run = [&](int mode) -> double {
+        const bool fresh = (st.live & (1u << mode)) == 0;
+        switch(mode){
+            case 0: {
+                const double g  = 1.0 + drive * 8.0;
+                const double T  = 1.0 / (double)sc::fastTanh((float)g);
+                const double a  = grit * 0.8;
+                const double u  = g * x;
+                // tanh and ln cosh from one exp: e = e^-2|u|
+                const double e  = std::exp(-2.0 * std::abs(u));
+                const double th = std::copysign((1.0 - e) / (1.0 + e), u);
+                double r1, r3;
+                if(aaOrder == 1){
+                    const double lc = std::abs(u) + std::log1p(e) - 0.693147180559945309;
+                    const double F3 = lc - 0.5 * th * th;
+                    if(fresh){ st.first[0].reset(u, lc); st.first[1].reset(u, F3); }
+                    r1 = st.first[0].next(u, lc, tanhFast);
+                    r3 = st.first[1].next(u, F3, tanhCubed);
+                } else {
+                    const double G  = sc::logCoshIntegral(u);
+                    const double G3 = G - 0.5 * (u - th);
+                    auto G3f = [](double v){ return sc::logCoshIntegral(v) - 0.5 * (v - std::tanh(v)); };
+                    if(fresh){ st.second[0].reset(u, G, sc::logCosh); st.second[1].reset(u, G3, tanhCubedF1); }
+                    r1 = st.second[0].next(u, G,  tanhFast, sc::logCosh, sc::logCoshIntegral);
+                    r3 = st.second[1].next(u, G3, tanhCubed, tanhCubedF1, G3f);
+                }
+                return T * (1.0 - a) * r1 + a * T * T * T * r3;
+            }
+            case 1: case 2: {
+                const double g = mode == 1 ? 1.0 + drive * 6.0 : 1.0 + drive * 12.0;
+                const double u = g * x;
+                const int    k = mode + 1;
+                auto f  = [&](double v){ return mode == 1 ? tubeCurve.f(v)  : clipCurve.f(v);  };
+                auto F1 = [&](double v){ return mode == 1 ? tubeCurve.F1(v) : clipCurve.F1(v); };
+                auto F2 = [&](double v){ return mode == 1 ? tubeCurve.F2(v) : clipCurve.F2(v); };
+                if(aaOrder == 1){
+                    if(fresh)       st.first[k].reset(u, F1(u));
+                    else if(regrit) st.first[k].refresh(F1);
+                    return st.first[k].next(u, F1(u), f);
+                }
+                if(fresh)       st.second[k].reset(u, F2(u), F1);
+                else if(regrit) st.second[k].refresh(F1, F2);
+                return st.second[k].next(u, F2(u), f, F1, F2);
+            }
+            default: {
+                const double u = (1.0 + drive * 4.0 + grit * 4.0) * x;
+                if(aaOrder == 1){
+                    if(fresh) st.first[4].reset(u, foldF1(u));
+                    return st.first[4].next(u, foldF1(u), foldF);
+                }
+                if(fresh) st.second[4].reset(u, foldF2(u), foldF1);
+                return st.second[4].next(u, foldF2(u), foldF, foldF1, foldF2);
+            }
+        }
+    };
+
+    double y = 0.0;
+    if(tf < 1.0f) y += run(ti) * (1.0 - tf);
+    if(tf > 0.0f) y += run(ti + 1) * tf;
+    st.live = liveNow;
+    return (float)y;
+}
+
+// ── SHAPER LOOKUP TABLES ──────────────────────────────────────────
+// Table density per SHAPER LUT choice, in points per unit of u. Memory for
+// a whole set and worst-case error against the exact curves:
+//   Small    64    8 KB   tape 7e-5  tube 4e-5  clip 6e-4
+//   Medium  256   31 KB   tape 5e-6  tube 3e-6  clip 4e-5
+//   Large  1024  122 KB   tape 9e-7  tube 3e-7  clip 3e-6
+// Clip is the worst case because grit sharpens its knee (k up to 8).
+namespace {
+constexpr int kTableDensity[] = { 0, 64, 256, 1024 };
+}
+
+// Samples the same double-precision curves ADAA uses. Every kink (tube at 0
+// and at its -1 clamp, clip at the knee and where it goes flat) is a table
+// end point, so only the smooth stretches are interpolated.
+void SaturaturProcessor::ShaperTables::build(float g, int d){
+    TubeCurve tc; tc.make(g);
+    ClipCurve cc; cc.make(g);
+    tanhPos.build([](double u){ return std::tanh(u); }, 0.0, 8.0, d);   // tanh(8) = 1 - 2e-7
+    tubeNeg.build([&](double u){ return tc.f(u); }, tc.uClamp, 0.0, d);
+    tubePos.build([&](double u){ return tc.f(u); }, 0.0, 16.0, d);
+    const double flat = std::min(cc.uClamp, cc.knee + 9.0 / cc.k);    // tanh(9) rounds to 1
+    clipBent.build([&](double u){ return cc.f(u); }, cc.knee, flat, d);
+    clipKnee  = (float)cc.knee;
+    clipSigma = (float)cc.sigma;
+    grit    = g;
+    density = d;
+}
+
+float SaturaturProcessor::ShaperTables::tape(float x, float drive, float amount) const {
+    const float g = 1.0f + drive * 8.0f;
+    const float u = x * g;
+    float s = std::copysign(tanhPos(std::abs(u)), u) / tanhPos(g);
+    if(amount > 0.0f)
+        s += amount * 0.8f * (s*s*s - s);
+    return s;
+}
+
+float SaturaturProcessor::ShaperTables::tube(float x, float drive) const {
+    const float u = x * (1.0f + drive * 6.0f);
+    return u >= 0.0f ? tubePos(u) : tubeNeg(u);
+}
+
+float SaturaturProcessor::ShaperTables::clip(float x, float drive) const {
+    const float u = x * (1.0f + drive * 12.0f);
+    const float a = std::abs(u);
+    return std::copysign(a <= clipKnee ? clipSigma * a : clipBent(a), u);
+}
+
+void SaturaturProcessor::TableBuilder::run(){
+    while(!threadShouldExit()){
+        buildRequested();
+        wait(-1);
+    }
+}
+
+bool SaturaturProcessor::TableBuilder::buildRequested(){
+    const int   density = owner.wantedDensity.load(std::memory_order_relaxed);
+    const float grit    = owner.wantedGrit.load(std::memory_order_relaxed);
+    if(density == 0 || (density == builtDensity && sc::sameBits(grit, builtGrit))) return false;
+    owner.tables.back().build(grit, density);
+    owner.tables.publish();
+    builtGrit    = grit;
+    builtDensity = density;
+    return true;
+}
+
+// Once per block: takes over any set the builder has finished and, when the
+// settings wanted now differ from the last posted, posts them and wakes the
+// builder. Grit is only posted once its smoother has settled, so automating
+// it never keeps the builder busy — the exact shapers cover the move.
+void SaturaturProcessor::requestTables(){
+    tables.acquire();
+    const int   density = kTableDensity[(int)*apvts.getRawParameterValue("shaperlut")];
+    const float grit    = smGrit.isSmoothing() ? wantedGrit.load(std::memory_order_relaxed) : smGrit.getTargetValue();
+    if(density == wantedDensity.load(std::memory_order_relaxed) && sc::sameBits(grit, wantedGrit.load(std::memory_order_relaxed)))
+        return;
+    wantedDensity.store(density, std::memory_order_relaxed);
+    wantedGrit.store(grit, std::memory_order_relaxed);
+    tableBuilder.notify();
+}
+
+// The current set if it matches this chunk's (steady) grit and the requested
+// density, else nullptr. Offline renders always take the exact shapers so a
+// bounce never depends on how quickly the builder thread got scheduled.
+const SaturaturProcessor::ShaperTables* SaturaturProcessor::tablesFor(const sc::ParamRamp& grit) const {
+    const ShaperTables& t = tables.front();
+    const bool match = !isNonRealtime() && !grit.moving && t.density != 0
+                    && t.density == wantedDensity.load(std::memory_order_relaxed) && sc::sameBits(t.grit, grit.steady);
+    return match ? &t : nullptr;
+}
+
+// ── STEADY-TYPE KERNELS ───────────────────────────────────────────
+template <int Mode, bool Tabled>
+float SaturaturProcessor::satMode(const ShaperTables* lut, float x, float d, float grit){
+    if constexpr(Tabled && Mode == 0) return lut->tape(x, d, grit);
+    else if constexpr(Tabled && Mode == 1) return lut->tube(x, d);
+    else if constexpr(Tabled && Mode == 2) return lut->clip(x, d);
+    else if constexpr(Mode == 0) return saturateTape(x, d, grit);
+    else if constexpr(Mode == 1) return saturateTube(x, d, grit);
+    else if constexpr(Mode == 2) return saturateClip(x, d, grit);
+    else return saturateFold(x, d, grit);
+}
+
+template <int Mode, bool Blend, bool Tabled, bool GritRamp>
+void SaturaturProcessor::shapeSteady(const float* in, const float* drive, float* out, int n, int shift,
+                                     const float* grit, float tf, const ShaperTables* lut){
+    for(int j = 0; j < n; j++){
+        const float d = drive[j >> shift];
+        const float g = GritRamp ? grit[j >> shift] : grit[0];
+        float y = satMode<Mode, Tabled>(lut, in[j], d, g);
+        if constexpr(Blend)
+            y = y * (1.0f - tf) + satMode<Mode + 1, Tabled>(lut, in[j], d, g) * tf;
+        out[j] = y;
+    }
+}
+
+// tf is exactly 0 or 1 whenever TYPE sits on one of the four modes. A moving
+// grit never has tables (tablesFor), so it only needs the exact shapers.
+SaturaturProcessor::SteadyKernel SaturaturProcessor::steadyKernel(int ti, float tf, bool tabled, bool gritRamp){
+    static constexpr SteadyKernel kernels[3][7] = {
+        { shapeSteady<0, false, false, false>, shapeSteady<1, false, false, false>, shapeSteady<2, false, false, false>, shapeSteady<3, false, false, false>,
+          shapeSteady<0, true,  false, false>, shapeSteady<1, true,  false, false>, shapeSteady<2, true,  false, false> },
+        { shapeSteady<0, false, true,  false>, shapeSteady<1, false, true,  false>, shapeSteady<2, false, true,  false>, shapeSteady<3, false, true,  false>,
+          shapeSteady<0, true,  true,  false>, shapeSteady<1, true,  true,  false>, shapeSteady<2, true,  true,  false> },
+        { shapeSteady<0, false, false, true>,  shapeSteady<1, false, false, true>,  shapeSteady<2, false, false, true>,  shapeSteady<3, false, false, true>,
+          shapeSteady<0, true,  false, true>,  shapeSteady<1, true,  false, true>,  shapeSteady<2, true,  false, true> }
+    };
+    const int k = tf <= 0.0f ? ti : tf >= 1.0f ? ti + 1 : 4 + ti;
+    return kernels[gritRamp ? 2 : tabled ? 1 : 0][k];
+}
+
 void SaturaturProcessor::prepareToPlay(double sr, int samplesPerBlock){
     sampleRate = sr;
-    toneLoL = toneLoR = warmLoL = warmLoR = 0.0f;
-    envL = envR = dcL = dcR = dcPrevL = dcPrevR = 0.0f;
-    compGainL = compGainR = 1.0f;
+    std::fill(std::begin(toneLo), std::end(toneLo), 0.0f);
+    std::fill(std::begin(warmLo), std::end(warmLo), 0.0f);
+    std::fill(std::begin(env),    std::end(env),    0.0f);
+    std::fill(std::begin(dc),     std::end(dc),     0.0f);
+    std::fill(std::begin(dcPrev), std::end(dcPrev), 0.0f);
+    std::fill(std::begin(compGain), std::end(compGain), 1.0f);
+
+    // The chunk loop never hands the oversampler more than kRampChunk samples
+    oversampler.prepare(kMaxChannels, sc::kRampChunk);
+    sc::prepareLogCoshIntegral();
+    curveGrit = -1.0f;
+    osStages = osFilter = -1;
+    updateAntiAliasing();
+    std::fill(&dryDelay[0][0], &dryDelay[0][0] + kDryDelaySize * kMaxChannels, 0.0f);
+    dryPos = 0;
+    sleep.reset();
 
     smDrive.reset(sr,  0.02); smDrive.setCurrentAndTargetValue(0.35f);
     smGrit.reset(sr,   0.02); smGrit.setCurrentAndTargetValue(0.3f);
@@ -87,10 +477,80 @@ void SaturaturProcessor::prepareToPlay(double sr, int samplesPerBlock){
     smMix.reset(sr,    0.02); smMix.setCurrentAndTargetValue(0.8f);
     smType.reset(sr,   0.08); smType.setCurrentAndTargetValue(0.0f);
     smComp.reset(sr,   0.05); smComp.setCurrentAndTargetValue(0.2f);
+
+    // Open with tables for the current settings already in place
+    tableBuilder.stopThread(1000);
+    wantedDensity = kTableDensity[(int)*apvts.getRawParameterValue("shaperlut")];
+    wantedGrit    = apvts.getRawParameterValue("bias")->load();
+    tableBuilder.buildRequested();
+    tables.acquire();
+    tableBuilder.startThread(juce::Thread::Priority::low);
+}
+
+// Applies the OVERSAMPLING / OS FILTER / ANTI-ALIAS choices. Re-running the
+// filters (or ADAA history) from clean state on a change is fine — it only
+// happens when the user flips a mode — and the host is told about the new
+// latency straight away. 2nd-order ADAA delays the wet path by one sample,
+// which is reported too when it runs at the base rate.
+void SaturaturProcessor::updateAntiAliasing(){
+    const int stages = (int)*apvts.getRawParameterValue("oversampling");
+    const int filter = (int)*apvts.getRawParameterValue("osfilter");
+    const int order  = (int)*apvts.getRawParameterValue("antialias");
+    if(stages == osStages && filter == osFilter && order == aaOrder) return;
+    osStages = stages;
+    osFilter = filter;
+    aaOrder  = order;
+    oversampler.setMode(stages, filter == 1 ? sc::Oversampler::Filter::linearPhaseFIR
+                                            : sc::Oversampler::Filter::minPhaseIIR);
+    std::fill(std::begin(adaa), std::end(adaa), AdaaState{});
+    const int lag = oversampler.latencySamples() + (aaOrder == 2 && stages == 0 ? 1 : 0);
+    jassert(lag < kDryDelaySize);
+    setLatencySamples(lag);
 }
 
+// Controls derived from the nine smoothed parameters. Built once per chunk
+// on the steady path, once per sample only while a parameter is ramping.
+struct SatControls {
+    float drive, grit, tone, attack, mix, comp;
+    float atkSlow, warmAmt, lpC, tf, outGain;
+    float compThresh, compRatio, compRel;
+    int   ti;
+
+    static SatControls make(float drive, float grit, float tone, float warmth, float attack,
+                            float output, float mix, float type, float comp,
+                            double sampleRate){
+        SatControls c;
+        c.drive = drive; c.grit = grit; c.tone = tone; c.attack = attack; c.mix = mix; c.comp = comp;
+        c.atkSlow = 0.001f + attack * 0.12f;
+
+        // Saturation type: 0..1 spans four modes, tf crossfades ti -> ti+1
+        const float t3 = type * 3.0f;
+        c.ti = juce::jmin((int)t3, 2);
+        c.tf = t3 - (float)c.ti;
+
+        c.warmAmt = warmth * 1.5f; // up to +150% low-mid boost
+
+        const float lpFreq = 500.0f + tone * 14000.0f;
+        c.lpC = 1.0f - (float)(2.0 * juce::MathConstants<double>::pi * lpFreq / sampleRate);
+
+        c.compThresh = 1.0f - comp * 0.85f; // more aggressive threshold
+        c.compRatio  = 1.0f + comp * 8.0f;  // increased ratio from 4.0 to 8.0
+        c.compRel    = 0.0001f + (1.0f - comp) * 0.05f;
+
+        // 0.5 = unity, range ±12dB
+        c.outGain = sc::fastPow(sc::kLog2Of10, (output - 0.5f) * 24.0f / 20.0f);
+        return c;
+    }
+};
+
+// Past the latency, how long input and output stay silent before processing
+// sleeps - a few time constants of the DC blocker and warmth filter, so what
+// is left in them stays under the silence threshold
+constexpr double kSleepSettleSeconds = 0.05;
+
 void SaturaturProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&){
     juce::ScopedNoDenormals noDenormals;
+    updateAntiAliasing();
 
     smDrive.setTargetValue (*apvts.getRawParameterValue("drive"));
     smGrit.setTargetValue  (*apvts.getRawParameterValue("bias"));
@@ -101,116 +561,268 @@ void SaturaturProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Mi
     smMix.setTargetValue   (*apvts.getRawParameterValue("mix"));
     smType.setTargetValue  (*apvts.getRawParameterValue("type"));
     smComp.setTargetValue  (*apvts.getRawParameterValue("param9"));
+    requestTables();
 
     const int N  = buffer.getNumSamples();
-    const int ch = buffer.getNumChannels();
-    auto* L = buffer.getWritePointer(0);
-    auto* R = ch > 1 ? buffer.getWritePointer(1) : buffer.getWritePointer(0);
+    const int ch = juce::jmin(buffer.getNumChannels(), kMaxChannels);
+    float* const* io = buffer.getArrayOfWritePointers();
+
+    // ── Sleep: silent in, silent out — nothing to shape ──
+    const float inPeak = sc::blockPeak(io, ch, N);
+    if(sleep.sleep(inPeak)){
+        for(auto* sm : { &smDrive, &smGrit, &smTone, &smWarmth, &smAttack, &smOutput, &smMix, &smType, &smComp })
+            sm->skip(N);
+        buffer.clear();
+        return;
+    }
 
     const float dcCoef = 1.0f - (float)(2.0 * juce::MathConstants<double>::pi * 20.0 / sampleRate);
 
-    for(int i = 0; i < N; i++){
-        const float drive  = smDrive.getNextValue();
-        const float grit   = smGrit.getNextValue();
-        const float tone   = smTone.getNextValue();
-        const float warmth = smWarmth.getNextValue();
-        const float attack = smAttack.getNextValue();
-        const float output = smOutput.getNextValue();
-        const float mix    = smMix.getNextValue();
-        const float type   = smType.getNextValue();
-        const float comp   = smComp.getNextValue();
-
-        const float dry0 = L[i], dry1 = R[i];
+    // ── WARMTH filter coefficient — fixed for the block ────────────
+    const float warmFreq = 300.0f;
+    const float warmC    = 1.0f - (float)(2.0 * juce::MathConstants<double>::pi * warmFreq / sampleRate);
+
+    auto getSat = [&](float x, float d, float grit, int mode) -> float {
+        switch(mode){
+            case 0: return saturateTape(x, d, grit);
+            case 1: return saturateTube(x, d, grit);
+            case 2: return saturateClip(x, d, grit);
+            default: return saturateFold(x, d, grit);
+        }
+    };
+
+    auto getSatTabled = [&](const ShaperTables& t, float x, float d, float grit, int mode) -> float {
+        switch(mode){
+            case 0: return t.tape(x, d, grit);
+            case 1: return t.tube(x, d);
+            case 2: return t.clip(x, d);
+            default: return saturateFold(x, d, grit);
+        }
+    };
+
+    // A chunk runs in three passes so the waveshaper can be oversampled on
+    // its own: envelope and drive at the base rate, shaping at the
+    // oversampled rate, then DC / warmth / tone / comp / mix at the base
+    // rate again. ctl(i) returns the controls for base-rate sample i; lut is
+    // the shaper table set to use, or nullptr for the exact shapers; kernel
+    // shapes the whole chunk when type holds still, else nullptr, reading
+    // grit per base-rate sample from grit.
+    //
+    // The base-rate passes run Lanes channels side by side (Lanes = channel
+    // count rounded up to 1 / 2 / 4 / 8; spare lanes carry silence). Every
+    // lane loop has a fixed trip count and no per-lane branches, so it
+    // compiles to a few vector ops per sample whatever the channel count.
+    auto runChunk = [&](auto lanes, const int start, const int n, const ShaperTables* lut, SteadyKernel kernel, const float* grit, auto&& ctl){
+        constexpr int Lanes = decltype(lanes)::value;
+
+        // Channels -> lanes; spare lanes carry silence
+        auto toLanes = [&](float (*dst)[kMaxChannels], auto&& channel){
+            for(int l = 0; l < Lanes; l++){
+                const float* src = l < ch ? channel(l) : nullptr;
+                for(int i = 0; i < n; i++)
+                    dst[i][l] = src != nullptr ? src[i] : 0.0f;
+            }
+        };
+        toLanes(laneIn, [&](int l){ return io[l] + start; });
 
         // ── ATTACK: envelope-based transient control ──────────────
         // attack=0: saturation hits hard on transients (punch)
         // attack=1: saturation smoothed — more sustain, less punch
-        const float atkFast = 0.002f;
-        const float atkSlow = 0.001f + attack * 0.12f;
-        const float aL = std::abs(dry0), aR = std::abs(dry1);
-        envL = aL > envL ? envL + (aL - envL) * atkFast : envL + (aL - envL) * atkSlow;
-        envR = aR > envR ? envR + (aR - envR) * atkFast : envR + (aR - envR) * atkSlow;
-        // Reduce drive on transients when attack is low (preserve punch) - increased from 0.5f to 0.85f
-        const float tDriveL = drive * (1.0f - (1.0f - attack) * 0.85f * juce::jmin(envL * 3.0f, 1.0f));
-        const float tDriveR = drive * (1.0f - (1.0f - attack) * 0.85f * juce::jmin(envR * 3.0f, 1.0f));
+        // (filter state is copied into locals for the chunk so it can live
+        // in registers rather than being reloaded through memory every sample)
+        float envLane[(size_t)Lanes];
+        std::copy_n(env, Lanes, envLane);
+        for(int i = 0; i < n; i++){
+            const SatControls& c = ctl(i);
+            const float atkFast = 0.002f;
+            const float atkSlow = c.atkSlow;
+            for(int l = 0; l < Lanes; l++){
+                const float a = std::abs(laneIn[i][l]);
+                envLane[l] = a > envLane[l] ? envLane[l] + (a - envLane[l]) * atkFast : envLane[l] + (a - envLane[l]) * atkSlow;
+                // Reduce drive on transients when attack is low (preserve punch) - increased from 0.5f to 0.85f
+                laneDrive[i][l] = c.drive * (1.0f - (1.0f - c.attack) * 0.85f * juce::jmin(envLane[l] * 3.0f, 1.0f));
+            }
+        }
+        std::copy_n(envLane, Lanes, env);
+        for(int l = 0; l < ch; l++)
+            for(int i = 0; i < n; i++)
+                chunkDrive[l][i] = laneDrive[i][l];
 
         // ── SATURATION TYPE (smooth crossfade between 4 modes) ────
-        const float t3   = type * 3.0f;
-        const int   ti   = juce::jmin((int)t3, 2);
-        const float tf   = t3 - (float)ti;
-
-        auto getSat = [&](float x, float d, int mode) -> float {
-            switch(mode){
-                case 0: return saturateTape(x, d, grit);
-                case 1: return saturateTube(x, d, grit);
-                case 2: return saturateClip(x, d, grit);
-                default: return saturateFold(x, d, grit);
+        auto shape = [&](AdaaState& st, float x, float d, const SatControls& c){
+            if(aaOrder != 0)
+                return shapeAntialiased(st, x, d, c.grit, c.ti, c.tf);
+            if(lut != nullptr)
+                return getSatTabled(*lut, x, d, c.grit, c.ti) * (1.0f - c.tf) + getSatTabled(*lut, x, d, c.grit, c.ti+1) * c.tf;
+            return getSat(x, d, c.grit, c.ti) * (1.0f - c.tf) + getSat(x, d, c.grit, c.ti+1) * c.tf;
+        };
+        auto shapeChannel = [&](const int chan, const float* in, const float* drv, float* wet){
+            AdaaState& st = adaa[chan];
+            const bool steady = kernel != nullptr && aaOrder == 0;
+            if(oversampler.numStages() == 0){
+                if(steady){
+                    kernel(in, drv, wet, n, 0, grit, ctl(0).tf, lut);
+                    return;
+                }
+                for(int i = 0; i < n; i++)
+                    wet[i] = shape(st, in[i], drv[i], ctl(i));
+                return;
             }
+            // Controls and drive hold for the factor() samples of each input sample
+            const int shift = oversampler.numStages();
+            float* hi = oversampler.up(chan, in, n);
+            if(steady)
+                kernel(hi, drv, hi, n << shift, shift, grit, ctl(0).tf, lut);
+            else
+                for(int j = 0; j < (n << shift); j++)
+                    hi[j] = shape(st, hi[j], drv[j >> shift], ctl(j >> shift));
+            oversampler.down(chan, wet, n);
         };
+        for(int l = 0; l < ch; l++)
+            shapeChannel(l, io[l] + start, chunkDrive[l], chunkWet[l]);
+        toLanes(laneWet, [&](int l){ return chunkWet[l]; });
 
-        float wetL = getSat(dry0, tDriveL, ti) * (1.0f - tf) + getSat(dry0, tDriveL, ti+1) * tf;
-        float wetR = getSat(dry1, tDriveR, ti) * (1.0f - tf) + getSat(dry1, tDriveR, ti+1) * tf;
-
-        // ── DC BLOCKER ────────────────────────────────────────────
-        float newDcL = wetL + dcCoef * dcL - dcPrevL;
-        dcPrevL = wetL; dcL = newDcL; wetL = newDcL;
-        float newDcR = wetR + dcCoef * dcR - dcPrevR;
-        dcPrevR = wetR; dcR = newDcR; wetR = newDcR;
-
-        // ── WARMTH — low-mid shelf boost on wet signal ────────────
-        // Adds body and fullness — very audible and musical
-        const float warmFreq = 300.0f;
-        const float warmC    = 1.0f - (float)(2.0 * juce::MathConstants<double>::pi * warmFreq / sampleRate);
-        warmLoL = warmLoL * warmC + wetL * (1.0f - warmC);
-        warmLoR = warmLoR * warmC + wetR * (1.0f - warmC);
-        const float warmAmt = warmth * 1.5f; // up to +150% low-mid boost
-        wetL += warmAmt * warmLoL;
-        wetR += warmAmt * warmLoR;
-
-        // ── TONE — tilt EQ (dark to bright) ──────────────────────
-        const float lpFreq = 500.0f + tone * 14000.0f;
-        const float lpC    = 1.0f - (float)(2.0 * juce::MathConstants<double>::pi * lpFreq / sampleRate);
-        toneLoL = toneLoL * lpC + wetL * (1.0f - lpC);
-        toneLoR = toneLoR * lpC + wetR * (1.0f - lpC);
-        if(tone < 0.5f){
-            // Dark — blend toward LP
-            wetL = toneLoL + (tone * 2.0f) * (wetL - toneLoL);
-            wetR = toneLoR + (tone * 2.0f) * (wetR - toneLoR);
-        } else {
-            // Bright — boost highs (increased from 1.2f to 2.5f)
-            wetL = wetL + (tone - 0.5f) * 2.5f * (wetL - toneLoL);
-            wetR = wetR + (tone - 0.5f) * 2.5f * (wetR - toneLoR);
+        const int dryLag = getLatencySamples();
+        // Each sample's lanes are worked on in locals too, so the compiler
+        // sees no aliasing and turns every lane loop into vector ops
+        float dcLane[(size_t)Lanes], dcPrevLane[(size_t)Lanes], warmLane[(size_t)Lanes], toneLane[(size_t)Lanes], gainLane[(size_t)Lanes];
+        std::copy_n(dc, Lanes, dcLane);         std::copy_n(dcPrev, Lanes, dcPrevLane);
+        std::copy_n(warmLo, Lanes, warmLane);   std::copy_n(toneLo, Lanes, toneLane);
+        std::copy_n(compGain, Lanes, gainLane);
+        for(int i = 0; i < n; i++){
+            const SatControls& c = ctl(i);
+            const float tone = c.tone;
+            const float mix  = c.mix;
+
+            // Dry path delayed by the oversampler's latency (0 = passthrough)
+            float wet[(size_t)Lanes], dry[(size_t)Lanes];
+            const int rd = (dryPos - dryLag) & (kDryDelaySize - 1);
+            for(int l = 0; l < Lanes; l++) dryDelay[dryPos][l] = laneIn[i][l];
+            for(int l = 0; l < Lanes; l++) dry[l] = dryDelay[rd][l];
+            for(int l = 0; l < Lanes; l++) wet[l] = laneWet[i][l];
+            dryPos = (dryPos + 1) & (kDryDelaySize - 1);
+
+            // ── DC BLOCKER ────────────────────────────────────────────
+            for(int l = 0; l < Lanes; l++){
+                const float newDc = wet[l] + dcCoef * dcLane[l] - dcPrevLane[l];
+                dcPrevLane[l] = wet[l]; dcLane[l] = newDc; wet[l] = newDc;
+            }
+
+            // ── WARMTH — low-mid shelf boost on wet signal ────────────
+            // Adds body and fullness — very audible and musical
+            for(int l = 0; l < Lanes; l++){
+                warmLane[l] = warmLane[l] * warmC + wet[l] * (1.0f - warmC);
+                wet[l] += c.warmAmt * warmLane[l];
+            }
+
+            // ── TONE — tilt EQ (dark to bright) ──────────────────────
+            const float lpC = c.lpC;
+            for(int l = 0; l < Lanes; l++)
+                toneLane[l] = toneLane[l] * lpC + wet[l] * (1.0f - lpC);
+            if(tone < 0.5f){
+                // Dark — blend toward LP
+                for(int l = 0; l < Lanes; l++)
+                    wet[l] = toneLane[l] + (tone * 2.0f) * (wet[l] - toneLane[l]);
+            } else {
+                // Bright — boost highs (increased from 1.2f to 2.5f)
+                for(int l = 0; l < Lanes; l++)
+                    wet[l] = wet[l] + (tone - 0.5f) * 2.5f * (wet[l] - toneLane[l]);
+            }
+
+            // ── COMP — soft saturation compression ───────────────────
+            // Reduces gain as signal gets louder — adds glue and density
+            if(c.comp > 0.0f){
+                const float compThresh = c.compThresh;
+                const float compRatio  = c.compRatio;
+                const float compAttack = 0.001f;
+                const float compRel    = c.compRel;
+                for(int l = 0; l < Lanes; l++){
+                    // Over the threshold: attack toward the reduced gain, else release to 1
+                    const float lev  = std::abs(wet[l]);
+                    const bool  over = lev > compThresh;
+                    const float goal = over ? (compThresh + (lev - compThresh) / compRatio) / juce::jmax(lev, 0.001f) : 1.0f;
+                    gainLane[l] += (goal - gainLane[l]) * (over ? compAttack : compRel);
+                    gainLane[l] = juce::jlimit(0.1f, 1.0f, gainLane[l]);
+                    wet[l] *= gainLane[l];
+                }
+            }
+
+            // ── PARALLEL MIX + SAFETY CLIP ───────────────────────────
+            for(int l = 0; l < Lanes; l++)
+                wet[l] = juce::jlimit(-1.0f, 1.0f, ((1.0f - mix) * dry[l] + mix * wet[l]) * c.outGain);
+            for(int l = 0; l < Lanes; l++) laneWet[i][l] = wet[l];
         }
+        std::copy_n(dcLane, Lanes, dc);         std::copy_n(dcPrevLane, Lanes, dcPrev);
+        std::copy_n(warmLane, Lanes, warmLo);   std::copy_n(toneLane, Lanes, toneLo);
+        std::copy_n(gainLane, Lanes, compGain);
 
-        // ── COMP — soft saturation compression ───────────────────
-        // Reduces gain as signal gets louder — adds glue and density
-        if(comp > 0.0f){
-            const float compThresh = 1.0f - comp * 0.85f; // more aggressive threshold
-            const float compRatio  = 1.0f + comp * 8.0f;  // increased ratio from 4.0 to 8.0
-            const float compAttack = 0.001f;
-            const float compRel    = 0.0001f + (1.0f - comp) * 0.05f;
-            const float levL = std::abs(wetL), levR = std::abs(wetR);
-            if(levL > compThresh)
-                compGainL += ((compThresh + (levL - compThresh) / compRatio) / juce::jmax(levL, 0.001f) - compGainL) * compAttack;
-            else
-                compGainL += (1.0f - compGainL) * compRel;
-            if(levR > compThresh)
-                compGainR += ((compThresh + (levR - compThresh) / compRatio) / juce::jmax(levR, 0.001f) - compGainR) * compAttack;
-            else
-                compGainR += (1.0f - compGainR) * compRel;
-            compGainL = juce::jlimit(0.1f, 1.0f, compGainL);
-            compGainR = juce::jlimit(0.1f, 1.0f, compGainR);
-            wetL *= compGainL;
-            wetR *= compGainR;
+        for(int l = 0; l < ch; l++)
+            for(int i = 0; i < n; i++)
+                io[l][start + i] = laneWet[i][l];
+    };
+
+    // Steady parameters (the usual case) run with the controls hoisted;
+    // only chunks where a smoother is moving build them per sample.
+    auto runBlock = [&](auto lanes){
+        for(int start = 0; start < N; start += sc::kRampChunk){
+            const int n = juce::jmin(sc::kRampChunk, N - start);
+            rampDrive.fill(smDrive, n);   rampGrit.fill(smGrit, n);     rampTone.fill(smTone, n);
+            rampWarmth.fill(smWarmth, n); rampAttack.fill(smAttack, n); rampOutput.fill(smOutput, n);
+            rampMix.fill(smMix, n);       rampType.fill(smType, n);     rampComp.fill(smComp, n);
+
+            const ShaperTables* lut = tablesFor(rampGrit);
+            // ADAA's tube and clip curves follow grit once per chunk, at the
+            // value its ramp ends on (a 48-step bisection is too much per sample)
+            if(aaOrder != 0 && !sc::sameBits(rampGrit.steady, curveGrit)){
+                tubeCurve.make(rampGrit.steady);
+                clipCurve.make(rampGrit.steady);
+                curveGrit = rampGrit.steady;
+            }
+            if(sc::anyMoving(rampDrive, rampGrit, rampTone, rampWarmth, rampAttack,
+                             rampOutput, rampMix, rampType, rampComp)){
+                SatControls ctl[sc::kRampChunk];
+                for(int i = 0; i < n; i++)
+                    ctl[i] = SatControls::make(rampDrive[i], rampGrit[i], rampTone[i], rampWarmth[i], rampAttack[i],
+                                               rampOutput[i], rampMix[i], rampType[i], rampComp[i],
+                                               sampleRate);
+                // Only a moving TYPE needs both shapers per sample; a moving
+                // grit alone still runs the steady-type kernel
+                const SteadyKernel kernel = rampType.moving ? nullptr
+                                          : steadyKernel(ctl[0].ti, ctl[0].tf, lut != nullptr, rampGrit.moving);
+                const float* grit = rampGrit.moving ? rampGrit.ramp : &rampGrit.steady;
+                runChunk(lanes, start, n, lut, kernel, grit, [&](int i) -> const SatControls& { return ctl[i]; });
+            } else {
+                const auto c = SatControls::make(rampDrive.steady, rampGrit.steady, rampTone.steady, rampWarmth.steady,
+                                                 rampAttack.steady, rampOutput.steady, rampMix.steady, rampType.steady,
+                                                 rampComp.steady, sampleRate);
+                runChunk(lanes, start, n, lut, steadyKernel(c.ti, c.tf, lut != nullptr, false), &c.grit, [&](int) -> const SatControls& { return c; });
+            }
         }
+    };
 
-        // ── OUTPUT GAIN ───────────────────────────────────────────
-        // 0.5 = unity, range ±12dB
-        const float outGain = std::pow(10.0f, (output - 0.5f) * 24.0f / 20.0f);
+    if     (ch <= 1) runBlock(std::integral_constant<int, 1>{});
+    else if(ch == 2) runBlock(std::integral_constant<int, 2>{});
+    else if(ch <= 4) runBlock(std::integral_constant<int, 4>{});
+    else             runBlock(std::integral_constant<int, 8>{});
+    sleep.update(inPeak, sc::blockPeak(io, ch, N), N, getLatencySamples() + (int)(sampleRate * kSleepSettleSeconds));
+}
 
-        // ── PARALLEL MIX + SAFETY CLIP ───────────────────────────
-        L[i] = juce::jlimit(-1.0f, 1.0f, ((1.0f - mix) * dry0 + mix * wetL) * outGain);
-        R[i] = juce::jlimit(-1.0f, 1.0f, ((1.0f - mix) * dry1 + mix * wetR) * outGain);
+// Bypassed, the input comes out through the dry path's delay, so it lines
+// up with the wet path's latency the host still compensates for
+void SaturaturProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&){
+    sleep.reset();
+    const int dryLag = getLatencySamples();
+    if(dryLag == 0) return;
+    const int N  = buffer.getNumSamples();
+    const int ch = juce::jmin(buffer.getNumChannels(), kMaxChannels);
+    float* const* io = buffer.getArrayOfWritePointers();
+    for(int i = 0; i < N; i++){
+        const int rd = (dryPos - dryLag) & (kDryDelaySize - 1);
+        for(int l = 0; l < ch; l++){
+            dryDelay[dryPos][l] = io[l][i];
+            io[l][i] = dryDelay[rd][l];
+        }
+        dryPos = (dryPos + 1) & (kDryDelaySize - 1);
     }
 }
 
@@ -1,6 +1,13 @@
 #pragma once
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include "ParamRamp.h"
+#include "Oversampler.h"
+#include "ADAA.h"
+#include "CurveTable.h"
+#include "TripleBuffer.h"
+#include "SleepGate.h"
+#include <atomic>
 #include <cmath>
 
 class SaturaturProcessor : public juce::AudioProcessor {
@@ -8,8 +15,10 @@ public:
     SaturaturProcessor();
     ~SaturaturProcessor() override = default;
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override {}
+    void releaseResources() override { tableBuilder.stopThread(1000); }
+    bool isBusesLayoutSupported(const BusesLayout&) const override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
     const juce::String getName() const override { return "Saturatur"; }
@@ -31,18 +40,126 @@ private:
     static float saturateClip (float x, float drive, float grit);
     static float saturateFold (float x, float drive, float grit);
 
+    // Mono up to 7.1. The per-channel filter state is one lane per channel,
+    // so the recursive filters step every channel in a single vector op.
+    static constexpr int kMaxChannels = 8;
     // Tone filters
-    float toneLoL=0.0f, toneLoR=0.0f;
+    alignas(32) float toneLo[kMaxChannels] = {};
     // Warmth (low-mid shelf)
-    float warmLoL=0.0f, warmLoR=0.0f;
+    alignas(32) float warmLo[kMaxChannels] = {};
     // Attack envelope follower
-    float envL=0.0f, envR=0.0f;
+    alignas(32) float env[kMaxChannels] = {};
     // DC blocker
-    float dcL=0.0f, dcR=0.0f, dcPrevL=0.0f, dcPrevR=0.0f;
+    alignas(32) float dc[kMaxChannels] = {}, dcPrev[kMaxChannels] = {};
     // Comp (soft limiter state)
-    float compGainL=1.0f, compGainR=1.0f;
+    alignas(32) float compGain[kMaxChannels] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+
+    // Oversampling — only the waveshaper runs at the raised rate
+    sc::Oversampler oversampler;
+    int osStages=-1, osFilter=-1;   // mode last applied, -1 forces a re-apply
+    void updateAntiAliasing();
+
+    // ADAA — the shapers as curves of the driven input u = drive gain * x,
+    // with closed-form antiderivatives (see the ADAA section in the .cpp).
+    // Tube and clip change shape with grit, so they are rebuilt when it moves.
+    struct TubeCurve {
+        double b=0.0, n[4]={}, uClamp=0.0, F1c=0.0, F2c=0.0;
+        void   make(float grit);
+        double f (double u) const;
+        double F1(double u) const;
+        double F2(double u) const;
+    };
+    struct ClipCurve {
+        double knee=0.0, k=0.0, sigma=0.0, uClamp=0.0, F1k=0.0, F2k=0.0, F1c=0.0, F2c=0.0;
+        void   make(float grit);
+        double f (double u) const;
+        double F1(double u) const;
+        double F2(double u) const;
+    };
+    // Per channel: tape (tanh, tanh^3 basis), tube, clip, fold
+    struct AdaaState {
+        sc::ADAA1 first[5];
+        sc::ADAA2 second[5];
+        unsigned  live=0;          // modes shaped on the previous sample
+        float     grit=-1.0f;      // grit the cached antiderivatives were taken at
+    };
+    AdaaState adaa[kMaxChannels];
+    TubeCurve tubeCurve;
+    ClipCurve clipCurve;
+    float curveGrit=-1.0f;
+    int   aaOrder=0;               // 0 = off, 1 / 2 = ADAA order
+    float shapeAntialiased(AdaaState& st, float x, float drive, float grit, int ti, float tf);
+
+    // Shaper lookup tables (SHAPER LUT) — tape, tube and clip as curves of u,
+    // tabulated at a fixed density. Tube and clip depend on grit, so a set is
+    // only valid for the grit it was built at: a background thread rebuilds
+    // it when grit settles somewhere new and hands it over through a triple
+    // buffer. Until the matching set arrives the exact shapers run. Fold has
+    // no transcendental and always runs exact.
+    struct ShaperTables {
+        float grit=-1.0f;
+        int   density=0;               // points per unit of u, 0 = not built
+        sc::CurveTable tanhPos;        // tanh on u >= 0
+        sc::CurveTable tubeNeg, tubePos;
+        sc::CurveTable clipBent;       // clip above the knee, |u| in [knee, flat]
+        float clipKnee=0.0f, clipSigma=0.0f;
+        void  build(float grit, int density);
+        float tape(float x, float drive, float amount) const;   // amount = grit
+        float tube(float x, float drive) const;
+        float clip(float x, float drive) const;
+    };
+    // Shaping kernels for chunks where type holds still: mode Mode alone,
+    // or crossfaded into Mode+1 by tf when Blend. One is picked per chunk,
+    // so the per-sample loop has no mode switch and never runs a shaper
+    // whose weight is 0. shift = oversampling stages (drive and grit are per
+    // base-rate sample); grit[0] is used throughout unless GritRamp.
+    template <int Mode, bool Tabled>
+    static float satMode(const ShaperTables* lut, float x, float drive, float grit);
+    template <int Mode, bool Blend, bool Tabled, bool GritRamp>
+    static void shapeSteady(const float* in, const float* drive, float* out, int n, int shift,
+                            const float* grit, float tf, const ShaperTables* lut);
+    using SteadyKernel = void (*)(const float*, const float*, float*, int, int, const float*, float, const ShaperTables*);
+    static SteadyKernel steadyKernel(int ti, float tf, bool tabled, bool gritRamp);
+
+    // Sleeps until the audio thread notifies it of a new grit / density, so
+    // an idle instance costs no wakeups. The notify only happens when the
+    // request changes: when grit settles somewhere new or SHAPER LUT moves.
+    class TableBuilder : public juce::Thread {
+    public:
+        explicit TableBuilder(SaturaturProcessor& p) : juce::Thread("Saturatur shaper tables"), owner(p) {}
+        ~TableBuilder() override { stopThread(1000); }
+        void run() override;
+        bool buildRequested();         // builds and publishes if the request changed
+    private:
+        SaturaturProcessor& owner;
+        float builtGrit=-1.0f;
+        int   builtDensity=0;
+    };
+    sc::TripleBuffer<ShaperTables> tables;
+    std::atomic<float> wantedGrit{-1.0f};
+    std::atomic<int>   wantedDensity{0};
+    void requestTables();
+    const ShaperTables* tablesFor(const sc::ParamRamp& grit) const;
+
+    // Linear-phase mode delays the wet path; the dry path is delayed to match
+    static constexpr int kDryDelaySize = 128;
+    alignas(32) float dryDelay[kDryDelaySize][kMaxChannels] = {};
+    int   dryPos=0;
+    // Sleeps once input and output have been silent past the latency and
+    // the DC blocker's settling
+    sc::SleepGate sleep;
+    // Per-chunk scratch. The base-rate passes work on lanes (sample-major,
+    // one lane per channel); shaping works per channel, so drive and wet are
+    // transposed across in between.
+    alignas(32) float laneIn[sc::kRampChunk][kMaxChannels] = {};
+    alignas(32) float laneDrive[sc::kRampChunk][kMaxChannels] = {};
+    alignas(32) float laneWet[sc::kRampChunk][kMaxChannels] = {};
+    float chunkDrive[kMaxChannels][sc::kRampChunk] = {};
+    float chunkWet[kMaxChannels][sc::kRampChunk] = {};
 
     juce::SmoothedValue<float,juce::ValueSmoothingTypes::Linear> smDrive,smGrit,smTone,smWarmth,smAttack,smOutput,smMix,smType,smComp;
+    sc::ParamRamp rampDrive,rampGrit,rampTone,rampWarmth,rampAttack,rampOutput,rampMix,rampType,rampComp;
     double sampleRate=44100.0;
+    TableBuilder tableBuilder{*this};   // last, so it stops before the tables go
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SaturaturProcessor)
 };
@@ -0,0 +1,146 @@
+#pragma once
+#include <cmath>
+
+// Antiderivative anti-aliasing (Parker et al. 2016; Bilbao et al. 2017).
+//
+// A memoryless shaper f is replaced by the average of f over the segment
+// between consecutive inputs, which is a divided difference of its
+// antiderivative. First order uses F1 = ∫f, second order F2 = ∫∫f. Both
+// run in double: F grows like x^2 / x^3 and the differences cancel.
+//
+// When consecutive inputs are closer than kIllConditioned the divided
+// difference is 0/0-ish, so the step falls back to evaluating the lower-
+// order function at the segment midpoint, which is the limit it tends to.
+//
+// The callers hand in F(x) for the new input (so a shaper that shares work
+// between its antiderivatives computes it once) plus callables for the
+// fallback paths.
+
+namespace sc {
+
+constexpr double kIllConditioned = 1.0e-5;
+
+struct ADAA1 {
+    double x1 = 0.0, F1x1 = 0.0;
+
+    template <class Fn>
+    double next(double x, double F1x, Fn&& f) {
+        const double dx = x - x1;
+        const double y  = std::abs(dx) > kIllConditioned ? (F1x - F1x1) / dx : f(0.5 * (x + x1));
+        x1 = x; F1x1 = F1x;
+        return y;
+    }
+
+    // Start over at x (no history), e.g. when a shaper comes back into use
+    void reset(double x, double F1x) { x1 = x; F1x1 = F1x; }
+
+    // The shaper's parameters changed: re-take the cached value with them
+    template <class F1Fn>
+    void refresh(F1Fn&& F1) { F1x1 = F1(x1); }
+};
+
+struct ADAA2 {
+    double x1 = 0.0, x2 = 0.0, F2x1 = 0.0, d1 = 0.0;
+
+    template <class Fn, class F1Fn, class F2Fn>
+    double next(double x, double F2x, Fn&& f, F1Fn&& F1, F2Fn&& F2) {
+        const double d = divided(x, x1, F2x, F2x1, F1);
+        double y;
+        if (std::abs(x - x2) > kIllConditioned) {
+            y = 2.0 * (d - d1) / (x - x2);
+        } else {
+            // x ~ x2: expand around the mean of the outer pair instead
+            const double xBar  = 0.5 * (x + x2);
+            const double delta = xBar - x1;
+            y = std::abs(delta) > kIllConditioned
+                  ? 2.0 / delta * (F1(xBar) + (F2x1 - F2(xBar)) / delta)
+                  : f(0.5 * (xBar + x1));
+        }
+        x2 = x1; x1 = x; F2x1 = F2x; d1 = d;
+        return y;
+    }
+
+    template <class F1Fn>
+    void reset(double x, double F2x, F1Fn&& F1) { x1 = x2 = x; F2x1 = F2x; d1 = F1(x); }
+
+    template <class F1Fn, class F2Fn>
+    void refresh(F1Fn&& F1, F2Fn&& F2) {
+        F2x1 = F2(x1);
+        d1   = divided(x1, x2, F2x1, F2(x2), F1);
+    }
+
+private:
+    template <class F1Fn>
+    static double divided(double a, double b, double F2a, double F2b, F1Fn&& F1) {
+        return std::abs(a - b) > kIllConditioned ? (F2a - F2b) / (a - b) : F1(0.5 * (a + b));
+    }
+};
+
+// ── ln cosh and its integral ─────────────────────────────────────────
+// Used by every tanh-based shaper: ∫tanh = ln cosh, ∫ln cosh = G. G has no
+// elementary form (it is a dilogarithm), so it is tabulated as
+//   G(u) = u^2/2 - u ln2 + pi^2/24 - c(u),   c(u) = ∫[u,inf) ln(1 + e^-2t) dt
+// for u >= 0, with c on a 1/64 grid and cubic Hermite between points using
+// the exact slope. Absolute error < 2e-10. G is odd.
+
+inline double logCosh(double u) {
+    const double a = std::abs(u);
+    return a + std::log1p(std::exp(-2.0 * a)) - 0.693147180559945309;
+}
+
+namespace adaa_detail {
+    struct LogCoshIntegralTable {
+        static constexpr int    kPerUnit = 64;
+        static constexpr double kEnd     = 16.0;
+        static constexpr int    kSize    = (int)(kEnd * kPerUnit) + 1;
+        double c[kSize], dc[kSize];
+
+        static double slope(double t) { return std::log1p(std::exp(-2.0 * t)); }
+
+        LogCoshIntegralTable() {
+            // Integrate the slope backwards from where c is e^-2u / 2 to
+            // double precision, Simpson with 16 sub-steps per grid step.
+            const double h = 1.0 / kPerUnit, hs = h / 16.0;
+            double acc = 0.5 * std::exp(-2.0 * kEnd);
+            for (int i = kSize - 1; i >= 0; i--) {
+                if (i < kSize - 1) {
+                    const double hi = (i + 1) * h;
+                    for (int k = 0; k < 16; k++) {
+                        const double b = hi - k * hs, a = b - hs;
+                        acc += hs / 6.0 * (slope(a) + 4.0 * slope(0.5 * (a + b)) + slope(b));
+                    }
+                }
+                c[i]  = acc;
+                dc[i] = -slope(i * h);
+            }
+        }
+    };
+
+    inline const LogCoshIntegralTable& logCoshIntegralTable() {
+        static const LogCoshIntegralTable table;
+        return table;
+    }
+}
+
+// Builds the table. Call from prepareToPlay so the audio thread never does.
+inline void prepareLogCoshIntegral() { (void)adaa_detail::logCoshIntegralTable(); }
+
+inline double logCoshIntegral(double u) {
+    const auto& t = adaa_detail::logCoshIntegralTable();
+    const double a = std::abs(u);
+    double c;
+    if (a >= t.kEnd) {
+        c = 0.5 * std::exp(-2.0 * a);
+    } else {
+        const double p  = a * t.kPerUnit;
+        const int    i  = (int)p;
+        const double s  = p - i, h = 1.0 / t.kPerUnit;
+        const double s2 = s * s, s3 = s2 * s;
+        c = (2 * s3 - 3 * s2 + 1) * t.c[i]      + (s3 - 2 * s2 + s) * h * t.dc[i]
+          + (-2 * s3 + 3 * s2)    * t.c[i + 1]  + (s3 - s2) * h * t.dc[i + 1];
+    }
+    const double g = 0.5 * a * a - a * 0.693147180559945309 + 0.411233516712056609 - c;
+    return u < 0.0 ? -g : g;
+}
+
+} // namespace sc
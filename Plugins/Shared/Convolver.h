@@ -0,0 +1,419 @@
+#pragma once
+#include "FFT.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Zero-latency convolution of a mono input with a stereo impulse response,
+// partitioned non-uniformly (Gardner):
+//
+//   head     taps [0, 64): direct form, every sample
+//   level 0  taps [64, 1024): 64-tap partitions, FFTs on the calling
+//            thread every 64 samples
+//   level l  partitions of 64 * 8^l taps from twice that far in, FFTs on
+//            ConvolverPool's worker threads; the last level runs to the end
+//
+// A level with partition length P works on whole blocks of P input
+// samples. Each worker level starts 2P taps in, so what a block's task
+// makes is first heard a whole block after the block completes: that is
+// its deadline. If the audio thread gets there first and no worker has
+// started the task, it runs it itself. If a worker is still on it, the
+// audio thread does not wait: that level plays its last block again, and
+// its next task takes in the blocks it missed, so the input history stays
+// whole. The tail is smeared for the block rather than broken off.
+// Offline (setOffline) it waits instead, so a bounce never depends on
+// scheduling.
+//
+// Left and right ride in one complex FFT as its real and imaginary parts.
+// With a real input, the product splits back out the same way, so stereo
+// costs what mono would. Spectra stay in FFT's scrambled bin order.
+
+namespace sc {
+
+// Worker threads shared by every Convolver in the process: one per core
+// but one, at least one. Whatever task is queued with the earliest
+// deadline runs next, whichever instance it belongs to.
+class ConvolverPool {
+public:
+    struct Task {
+        enum { idle, queued, running, done };
+        std::atomic<int> state { idle };
+        std::atomic<int64_t> deadline { 0 };   // steady_clock ns
+        virtual void run() = 0;
+        virtual ~Task() = default;
+
+        // Audio thread: queue the task, due in `seconds`. Not while it is
+        // running.
+        void post(ConvolverPool& pool, double seconds) {
+            deadline.store(now() + (int64_t)(seconds * 1.0e9), std::memory_order_relaxed);
+            state.store(queued, std::memory_order_release);
+            pool.wake();
+        }
+        // Audio thread: runs the task here if no worker has taken it yet
+        void runIfQueued() {
+            int s = queued;
+            if (state.compare_exchange_strong(s, running, std::memory_order_acquire)) {
+                run();
+                state.store(done, std::memory_order_release);
+            }
+        }
+        // A worker has it. Acquires what the task wrote once it is not.
+        bool busy() const { return state.load(std::memory_order_acquire) == running; }
+        // Drops a queued task; false, and nothing done, while a worker
+        // is running it
+        bool drop() {
+            int s = queued;
+            if (!state.compare_exchange_strong(s, idle, std::memory_order_acquire) && s == running) return false;
+            state.store(idle, std::memory_order_relaxed);
+            return true;
+        }
+    };
+
+    static std::shared_ptr<ConvolverPool> shared() {
+        static std::mutex lock;
+        static std::weak_ptr<ConvolverPool> instance;
+        std::lock_guard<std::mutex> l(lock);
+        auto p = instance.lock();
+        if (p == nullptr) {
+            p.reset(new ConvolverPool());
+            instance = p;
+        }
+        return p;
+    }
+
+    ~ConvolverPool() {
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            quit = true;
+        }
+        wakeUp.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    // Not realtime. remove() returns once no worker is running the task.
+    void add(Task* t) {
+        std::lock_guard<std::mutex> l(mutex);
+        tasks.push_back(t);
+    }
+    void remove(Task* t) {
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            tasks.erase(std::remove(tasks.begin(), tasks.end(), t), tasks.end());
+        }
+        while (t->state.load(std::memory_order_acquire) == Task::running) std::this_thread::yield();
+    }
+
+    // Never blocks. It notifies without the lock, so a worker just about
+    // to wait can miss it; the task then runs with the next one posted, or
+    // on the audio thread at its deadline.
+    void wake() { wakeUp.notify_one(); }
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    ConvolverPool() {
+        const int n = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+        for (int i = 0; i < n; i++) threads.emplace_back([this] { work(); });
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> l(mutex);
+        while (!quit) {
+            Task* best = nullptr;
+            int64_t due = 0;
+            for (Task* t : tasks)
+                if (t->state.load(std::memory_order_relaxed) == Task::queued) {
+                    const int64_t d = t->deadline.load(std::memory_order_relaxed);
+                    if (best == nullptr || d < due) { best = t; due = d; }
+                }
+            if (best == nullptr) {
+                wakeUp.wait(l);
+                continue;
+            }
+            int s = Task::queued;
+            if (best->state.compare_exchange_strong(s, Task::running, std::memory_order_acquire)) {
+                l.unlock();
+                best->run();
+                best->state.store(Task::done, std::memory_order_release);
+                l.lock();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::vector<Task*> tasks;
+    std::vector<std::thread> threads;
+    bool quit = false;
+};
+
+class Convolver {
+public:
+    static constexpr int kHead = 64;
+
+    // Takes the response at sampleRate; right may be left. Allocates and
+    // transforms every partition, so belongs on a background thread.
+    Convolver(const float* left, const float* right, size_t length, double sampleRate)
+        : pool(ConvolverPool::shared()), len(length), rate(sampleRate) {
+        for (int k = 0; k < kHead; k++) {
+            headL[k] = k < (int)length ? left[k]  : 0.0f;
+            headR[k] = k < (int)length ? right[k] : 0.0f;
+        }
+        // Every level stops 16 partitions in, where the next one's 2P
+        // starts, but a worker level takes on the rest of the response
+        // rather than hand less than that much on to one eight times longer
+        size_t start = kHead, P = kHead, maxP = kHead;
+        while (start < length) {
+            const size_t end = !levels.empty() && length <= 32 * P ? length : std::min(length, 16 * P);
+            levels.push_back(std::make_unique<Level>(*this, (int)P, left, right, start, end, levels.empty()));
+            maxP = P;
+            start = end;
+            P *= 8;
+        }
+        // A task reads the 2P samples before its block ends while the next
+        // P are written, with as much again for a worker running late
+        const size_t need = 8 * maxP;
+        ringMask = 1;
+        while (ringMask < need) ringMask <<= 1;
+        ring.assign(ringMask, 0.0f);
+        ringMask--;
+        for (size_t l = 1; l < levels.size(); l++) pool->add(levels[l].get());
+    }
+
+    ~Convolver() {
+        for (size_t l = 1; l < levels.size(); l++) pool->remove(levels[l].get());
+    }
+
+    size_t length() const { return len; }
+    double sampleRate() const { return rate; }
+
+    // Realtime, and never waits: if a worker is still running a task, the
+    // output is silent until it finishes and the clearing can be done
+    void reset() { resetPending = true; }
+
+    // Offline the audio thread waits for a worker that is late, rather
+    // than leave a level silent
+    void setOffline(bool wait) { offline = wait; }
+
+    void process(const float* in, float* outL, float* outR, int n) {
+        if (resetPending && !clear()) {
+            std::fill_n(outL, n, 0.0f);
+            std::fill_n(outR, n, 0.0f);
+            return;
+        }
+        while (n > 0) {
+            const int m = std::min(n, kHead - (int)(count % kHead));
+
+            // Head: direct form over the newest kHead - 1 + m samples
+            float x[2 * kHead];
+            for (int i = 0; i < m; i++) ring[(count + (size_t)i) & ringMask] = in[i];
+            for (int i = 0; i < kHead - 1 + m; i++)
+                x[i] = ring[(count - (kHead - 1) + (size_t)i) & ringMask];
+            for (int i = 0; i < m; i++) outL[i] = outR[i] = 0.0f;
+            for (int k = 0; k < kHead; k++) {
+                const float* xk = x + (kHead - 1 - k);
+                const float hl = headL[k], hr = headR[k];
+                for (int i = 0; i < m; i++) {
+                    outL[i] += hl * xk[i];
+                    outR[i] += hr * xk[i];
+                }
+            }
+
+            for (auto& l : levels) {
+                const int at = (int)(count % (size_t)l->P);
+                const float* yl = l->out[l->playSide][0].data() + at;
+                const float* yr = l->out[l->playSide][1].data() + at;
+                for (int i = 0; i < m; i++) {
+                    outL[i] += yl[i];
+                    outR[i] += yr[i];
+                }
+            }
+
+            count += (size_t)m;
+            for (auto& l : levels)
+                if (count % (size_t)l->P == 0) l->blockDone(count);
+            in += m; outL += m; outR += m; n -= m;
+        }
+    }
+
+private:
+    // Drops every queued task and starts over empty, once no worker is
+    // running one
+    bool clear() {
+        for (auto& l : levels)
+            if (!l->inlined && !l->drop()) return false;
+        for (auto& l : levels) l->reset();
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        count = 0;
+        resetPending = false;
+        return true;
+    }
+
+    // One uniform partitioning: M partitions of P taps, FFT size 2P, with a
+    // delay line of the last M input spectra. Level 0 runs inline.
+    struct Level : ConvolverPool::Task {
+        Convolver& owner;
+        const int P, M;
+        const bool inlined;
+        FFT fft;
+        std::vector<float> hRe, hIm;        // M partition spectra, 2P bins each
+        std::vector<float> xRe, xIm;        // the last M input spectra
+        std::vector<float> accRe, accIm;
+        // Block outputs alternate between two sides: the block of input
+        // ending at count e goes to side (e / P) & 1. A task writes only
+        // its last block's side, never the one being played. The third,
+        // kHeld, is the audio thread's copy of the last block played, for
+        // when a worker is late.
+        static constexpr int kHeld = 2;
+        std::vector<float> out[3][2];       // [side][channel], P samples
+        int newest = 0;                     // xRe slot of the latest block
+        int playSide = 0;                   // out side being played
+        size_t target = 0;                  // input count the task runs up to
+        size_t doneEnd = 0;                 // input count the task has run up to
+
+        Level(Convolver& o, int p, const float* left, const float* right, size_t start, size_t end, bool first)
+            : owner(o), P(p), M((int)((end - start + (size_t)p - 1) / (size_t)p)), inlined(first) {
+            const size_t N = 2 * (size_t)P;
+            fft.prepare((int)N);
+            hRe.assign(N * (size_t)M, 0.0f);  hIm.assign(N * (size_t)M, 0.0f);
+            xRe.assign(N * (size_t)M, 0.0f);  xIm.assign(N * (size_t)M, 0.0f);
+            accRe.assign(N, 0.0f);            accIm.assign(N, 0.0f);
+            for (auto& side : out)
+                for (auto& ch : side) ch.assign((size_t)P, 0.0f);
+            // The 1 / N of the inverse transform is folded in here
+            const float scale = 1.0f / (float)N;
+            for (int m = 0; m < M; m++) {
+                float* re = hRe.data() + N * (size_t)m;
+                float* im = hIm.data() + N * (size_t)m;
+                for (size_t k = 0; k < (size_t)P; k++) {
+                    const size_t t = start + (size_t)m * (size_t)P + k;
+                    if (t >= end) break;
+                    re[k] = left[t] * scale;
+                    im[k] = right[t] * scale;
+                }
+                fft.forward(re, im);
+            }
+        }
+
+        // Not while a worker is running the task
+        void reset() {
+            std::fill(xRe.begin(), xRe.end(), 0.0f);
+            std::fill(xIm.begin(), xIm.end(), 0.0f);
+            for (auto& side : out)
+                for (auto& ch : side) std::fill(ch.begin(), ch.end(), 0.0f);
+            newest = 0;
+            playSide = 0;
+            target = doneEnd = 0;
+        }
+
+        static int sideOf(size_t end, int P) { return (int)((end / (size_t)P) & 1); }
+
+        // At the end of each block of P input samples (count of them so
+        // far): play the output the previous block's task made, and start
+        // on this block's. A worker still on an earlier task is left to
+        // it: the level holds its last block, and this block waits for
+        // the next task. A block the worker kept from its task is run
+        // here if it is the only one; after more, the level holds a block
+        // longer and they all go to the next task.
+        void blockDone(size_t count) {
+            if (inlined) {
+                target = count;
+                run();
+                playSide = sideOf(count, P);
+                return;
+            }
+            const size_t want = count - (size_t)P;
+            runIfQueued();
+            if (owner.offline)
+                while (busy()) std::this_thread::yield();
+            if (busy()) {
+                hold();
+                return;
+            }
+            if (doneEnd + (size_t)P == want) {
+                target = want;
+                run();
+            }
+            if (doneEnd == want) playSide = sideOf(want, P);
+            else                 hold();
+            target = count;
+            post(*owner.pool, (double)P / owner.rate);
+        }
+
+        // Plays the last block again until the level catches up. The copy
+        // is taken once, as it falls behind, from the side being played,
+        // which no worker writes.
+        void hold() {
+            if (playSide == kHeld) return;
+            for (int c = 0; c < 2; c++)
+                std::copy(out[playSide][c].begin(), out[playSide][c].end(), out[kHeld][c].begin());
+            playSide = kHeld;
+        }
+
+        // Every block from doneEnd up to target: the input spectrum for
+        // the 2P samples up to its end, and for the last, the products with
+        // every partition and back to P new output samples on its side.
+        // The earlier blocks' outputs were due while the level was behind.
+        void run() override {
+            while (doneEnd < target) {
+                doneEnd += (size_t)P;
+                runBlock(doneEnd, doneEnd == target);
+            }
+        }
+
+        void runBlock(size_t windowEnd, bool output) {
+            const size_t N = 2 * (size_t)P;
+            newest = newest + 1 == M ? 0 : newest + 1;
+            float* xr = xRe.data() + N * (size_t)newest;
+            float* xi = xIm.data() + N * (size_t)newest;
+            for (size_t i = 0; i < N; i++) {
+                xr[i] = owner.ring[(windowEnd - N + i) & owner.ringMask];
+                xi[i] = 0.0f;
+            }
+            fft.forward(xr, xi);
+            if (!output) return;
+
+            float* __restrict ar = accRe.data();
+            float* __restrict ai = accIm.data();
+            std::fill(accRe.begin(), accRe.end(), 0.0f);
+            std::fill(accIm.begin(), accIm.end(), 0.0f);
+            for (int m = 0, s = newest; m < M; m++, s = s == 0 ? M - 1 : s - 1) {
+                const float* __restrict hr = hRe.data() + N * (size_t)m;
+                const float* __restrict hi = hIm.data() + N * (size_t)m;
+                const float* __restrict br = xRe.data() + N * (size_t)s;
+                const float* __restrict bi = xIm.data() + N * (size_t)s;
+                for (size_t k = 0; k < N; k++) {
+                    ar[k] += br[k] * hr[k] - bi[k] * hi[k];
+                    ai[k] += br[k] * hi[k] + bi[k] * hr[k];
+                }
+            }
+            fft.inverse(ar, ai);
+
+            auto& side = out[sideOf(windowEnd, P)];
+            std::copy(ar + P, ar + N, side[0].begin());
+            std::copy(ai + P, ai + N, side[1].begin());
+        }
+    };
+
+    std::shared_ptr<ConvolverPool> pool;
+    size_t len;
+    double rate;
+    float headL[kHead] = {}, headR[kHead] = {};
+    std::vector<std::unique_ptr<Level>> levels;
+    std::vector<float> ring;            // input, indexed by count
+    size_t ringMask = 0;
+    size_t count = 0;                   // input samples so far
+    bool resetPending = false;
+    bool offline = false;
+};
+
+} // namespace sc
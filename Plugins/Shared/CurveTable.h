@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// A smooth curve sampled on a uniform grid over [lo, hi] and read back with
+// linear interpolation. Inputs outside the range clamp to the end values, so
+// a curve that saturates (tanh, a clipper) only needs tabulating up to where
+// it goes flat.
+//
+// Error is the interpolation error, at most step^2 / 8 * max|f''| on the
+// interval, plus float rounding (~2 ulp). Both ends are grid points, so a
+// curve with kinks stays exact there if it is split at them into separate
+// tables. Memory is (pointsPerUnit * (hi - lo) + 2) floats.
+//
+// build() allocates and is meant for a background thread; operator() is
+// branch-free and allocation-free.
+
+namespace sc {
+
+class CurveTable {
+public:
+    template <class Fn>
+    void build(Fn&& f, double lo, double hi, int pointsPerUnit) {
+        const int n = std::max(2, (int)std::ceil((hi - lo) * pointsPerUnit) + 1);
+        const double step = (hi - lo) / (n - 1);
+        values.resize((size_t)n + 1);
+        for (int i = 0; i < n; i++)
+            values[(size_t)i] = (float)f(i == n - 1 ? hi : lo + i * step);
+        values[(size_t)n] = values[(size_t)n - 1];   // lets the top point interpolate without a bounds check
+        origin  = (float)lo;
+        invStep = (float)(1.0 / step);
+        last    = (float)(n - 1);
+    }
+
+    float operator()(float x) const {
+        const float p = std::min(std::max((x - origin) * invStep, 0.0f), last);
+        const int   i = (int)p;
+        const float a = values[(size_t)i], b = values[(size_t)i + 1];
+        return a + (p - (float)i) * (b - a);
+    }
+
+    size_t bytes() const { return values.size() * sizeof(float); }
+
+private:
+    std::vector<float> values;
+    float origin = 0.0f, invStep = 0.0f, last = 0.0f;
+};
+
+} // namespace sc
@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Sparse early reflections: 16, 32 or 64 taps on a mono input, each with
+// its own delay, gain and pan, summed to stereo.
+//
+// The input ring is written twice, at i and at i + size, so the stretch
+// any tap reads for a block is one contiguous run wherever it starts. A
+// block is then two multiply-adds per tap over a plain run of floats,
+// which compilers vectorise without gathers.
+//
+// Every layout, at the full rate and at each halving of it, is worked out
+// in prepare(); setHalvings() and setTaps() only pick one. Taps fall
+// between 4 and 80 ms, thinly at first and more densely later, as in a
+// room, and die away over that span. Gains are scaled so that each layout
+// passes the same power, so the tap count changes the texture and not the
+// level.
+
+namespace sc {
+
+class EarlyReflections {
+public:
+    static constexpr int kMaxTaps = 64, kMaxBlock = 128, kMaxHalvings = 3;
+
+    // Lays out the taps at sampleRate and at up to halvings (<= kMaxHalvings)
+    // halvings of it, each channel passing the input at an RMS gain of
+    // level, and runs at the full rate. Not realtime.
+    void prepare(double sampleRate, int halvings, float level) {
+        const size_t need = (size_t)std::ceil(kLastSeconds * sampleRate) + kMaxBlock + 1;
+        size = 1;
+        while (size < need) size <<= 1;
+        mask = size - 1;
+        ring.assign(2 * size, 0.0f);
+        pos = 0;
+        for (int h = 0; h <= halvings; h++) {
+            longest[h] = 0;
+            for (int l = 0; l < kLayouts; l++) layOut(h, l, sampleRate / (1 << h), level);
+        }
+        halving = 0;
+    }
+
+    // Runs at prepare()'s rate halved h times, h no more than it laid out.
+    // Realtime safe; clears the input.
+    void setHalvings(int h) {
+        halving = h;
+        reset();
+    }
+
+    // 16, 32 or 64, or 0 for none. Clears the input when the count changes,
+    // since nothing is written while there are no taps.
+    void setTaps(int n) {
+        int l = -1;
+        for (int k = 0; k < kLayouts; k++)
+            if (kCounts[k] == n) l = k;
+        if (l == layout) return;
+        layout = l;
+        reset();
+    }
+    int taps() const { return layout < 0 ? 0 : kCounts[layout]; }
+
+    // Longest delay of any layout at the current rate, in samples
+    size_t length() const { return longest[halving]; }
+
+    void reset() {
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        pos = 0;
+    }
+
+    // n <= kMaxBlock samples of input to outL / outR (overwritten), while
+    // taps() is not 0. Taps shorter than the block read what it has just
+    // written.
+    void process(const float* in, float* outL, float* outR, int n) {
+        for (int i = 0; i < n; i++) {
+            const size_t p = (pos + (size_t)i) & mask;
+            ring[p] = ring[p + size] = in[i];
+        }
+        // Four taps to a pass, so the sums are loaded and stored once for
+        // every four runs read
+        float l[kMaxBlock] = {}, r[kMaxBlock] = {};
+        const Tap* taps = tap[halving][layout];
+        for (int k = 0; k < kCounts[layout]; k += 4) {
+            const float* s0 = ring.data() + ((pos - taps[k].delay) & mask);
+            const float* s1 = ring.data() + ((pos - taps[k + 1].delay) & mask);
+            const float* s2 = ring.data() + ((pos - taps[k + 2].delay) & mask);
+            const float* s3 = ring.data() + ((pos - taps[k + 3].delay) & mask);
+            const float l0 = taps[k].gainL, l1 = taps[k + 1].gainL, l2 = taps[k + 2].gainL, l3 = taps[k + 3].gainL;
+            const float r0 = taps[k].gainR, r1 = taps[k + 1].gainR, r2 = taps[k + 2].gainR, r3 = taps[k + 3].gainR;
+            for (int i = 0; i < n; i++) {
+                l[i] += (l0 * s0[i] + l1 * s1[i]) + (l2 * s2[i] + l3 * s3[i]);
+                r[i] += (r0 * s0[i] + r1 * s1[i]) + (r2 * s2[i] + r3 * s3[i]);
+            }
+        }
+        std::copy_n(l, n, outL);
+        std::copy_n(r, n, outR);
+        pos = (pos + (size_t)n) & mask;
+    }
+
+private:
+    static constexpr int kLayouts = 3;
+    static constexpr int kCounts[kLayouts] = { 16, 32, 64 };
+    static constexpr double kFirstSeconds = 0.004, kLastSeconds = 0.080;
+
+    struct Tap {
+        size_t delay = 1;
+        float  gainL = 0.0f, gainR = 0.0f;
+    };
+
+    void layOut(int h, int l, double sampleRate, float level) {
+        const int n = kCounts[l];
+        uint32_t seed = 0x2545F491u + (uint32_t)l;
+        auto random = [&seed] {   // [0, 1)
+            seed = seed * 1664525u + 1013904223u;
+            return (double)(seed >> 8) * (1.0 / 16777216.0);
+        };
+        const double pi = 3.14159265358979323846;
+        double power = 0.0;
+        for (int k = 0; k < n; k++) {
+            // Density rising with time: the k-th of n at the square root
+            // of its share, jittered within its slot
+            const double u = std::sqrt(((double)k + random()) / n);
+            const double t = kFirstSeconds + (kLastSeconds - kFirstSeconds) * u;
+            const double g = std::exp(-3.0 * (t - kFirstSeconds) / (kLastSeconds - kFirstSeconds))
+                           * (random() < 0.5 ? -1.0 : 1.0);
+            // Alternate sides, constant power, never quite hard over
+            const double side = (k & 1) ? 1.0 : -1.0;
+            const double angle = pi / 4.0 * (1.0 + side * (0.3 + 0.6 * random()));
+            Tap& p = tap[h][l][k];
+            p.delay = std::max<size_t>(1, (size_t)std::lround(t * sampleRate));
+            p.gainL = (float)(g * std::cos(angle));
+            p.gainR = (float)(g * std::sin(angle));
+            power += g * g;
+            longest[h] = std::max(longest[h], p.delay);
+        }
+        // The pans split each tap's power between the channels
+        const float scale = (float)(level * std::sqrt(2.0 / power));
+        for (int k = 0; k < n; k++) {
+            tap[h][l][k].gainL *= scale;
+            tap[h][l][k].gainR *= scale;
+        }
+    }
+
+    std::vector<float> ring;   // size samples, then the same again
+    size_t size = 0, mask = 0, pos = 0;
+    size_t longest[kMaxHalvings + 1] = {};
+    int halving = 0, layout = -1;
+    Tap tap[kMaxHalvings + 1][kLayouts][kMaxTaps];
+};
+
+} // namespace sc
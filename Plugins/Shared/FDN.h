@@ -0,0 +1,226 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "FastMath.h"
+
+// Feedback delay network: N delay lines (8 or 16) whose outputs are damped,
+// scaled and mixed back into their inputs through a dense orthogonal
+// matrix, with the input spread across all of them.
+//
+// The lines are lanes: four to a Quad, which GCC and Clang compile to one
+// SSE or NEON register, and a sample's whole recursion is a handful of
+// Quad ops. The matrix is a Hadamard across quads times a 4x4 Householder
+// reflection within each (I - 1/2), so every entry is +-1/sqrt(N), as
+// dense as a full Hadamard, without shuffling lanes inside a register.
+//
+// The ring interleaves the lines, one row of N per sample, so each
+// sample's new values go in with N/4 vector stores. process() takes blocks
+// no longer than the shortest line, so a block never reads what it writes.
+//
+// Decay is given as loop gain at DC and at Nyquist per so many seconds of
+// travel. Each line takes the share its own length accounts for, as a gain
+// and a one-pole lowpass, so every path through the network decays at the
+// same rate whatever lines it runs through.
+
+namespace sc {
+
+namespace fdn_detail {
+#if defined(__GNUC__) || defined(__clang__)
+    typedef float Quad __attribute__((vector_size(16)));
+#else
+    struct Quad {
+        float v[4];
+        float  operator[](int i) const { return v[i]; }
+        float& operator[](int i)       { return v[i]; }
+        friend Quad operator+(Quad a, Quad b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+        friend Quad operator-(Quad a, Quad b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+        friend Quad operator*(Quad a, Quad b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+        Quad& operator+=(Quad b) { return *this = *this + b; }
+        Quad& operator-=(Quad b) { return *this = *this - b; }
+    };
+#endif
+    inline Quad splat(float v)           { Quad q; for (int i = 0; i < 4; i++) q[i] = v; return q; }
+    inline Quad load(const float* p)     { Quad q; std::memcpy(&q, p, sizeof q); return q; }
+    inline void store(float* p, Quad q)  { std::memcpy(p, &q, sizeof q); }
+    inline float sum(Quad q)             { return (q[0] + q[1]) + (q[2] + q[3]); }
+}
+
+template <int N>
+class FDN {
+    static_assert(N == 8 || N == 16, "FDN lanes are laid out for 8 or 16 lines");
+    using Quad = fdn_detail::Quad;
+    static constexpr int Q = N / 4;
+
+public:
+    static constexpr int kMaxBlock = 128;
+    // Eight lines have seven Hadamard rows beside the all-ones one, which
+    // the input signs would colour; sixteen offer the same seven
+    static constexpr int kMaxOutputs = 7;
+
+    // Allocates for rates up to maxSampleRate. Not realtime.
+    void prepare(double maxSampleRate) {
+        const size_t need = (size_t)(baseLength(N - 1) * maxSampleRate / 48000.0) + kMaxBlock + 1;
+        rows = 1;
+        while (rows < need) rows <<= 1;
+        mask = rows - 1;
+        ring.assign(rows * N, 0.0f);
+        setSampleRate(maxSampleRate);
+    }
+
+    // Line lengths for sr, which is at most prepare()'s. Realtime safe;
+    // clears the network.
+    void setSampleRate(double sr) {
+        rate = sr;
+        for (int j = 0; j < N; j++)
+            len[j] = std::max<size_t>(kMaxBlock, (size_t)(baseLength(j) * sr / 48000.0));
+        lastGain = lastNyquist = lastSeconds = -1.0f;
+        reset();
+    }
+
+    void reset() {
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        std::fill(lp, lp + N, 0.0f);
+        pos = 0;
+    }
+
+    // Shortest line: process() blocks must not be longer
+    int minDelay() const { return (int)len[0]; }
+
+    // Loop gain at DC and at Nyquist (0..1) for every `seconds` of travel
+    void setDecay(float gain, float nyquistGain, float seconds) {
+        if (sameBits(gain, lastGain) && sameBits(nyquistGain, lastNyquist) && sameBits(seconds, lastSeconds)) return;
+        lastGain = gain; lastNyquist = nyquistGain; lastSeconds = seconds;
+        const double lnGain = std::log(std::max(gain, 1.0e-6f));
+        const double lnTilt = std::log(std::clamp(nyquistGain / std::max(gain, 1.0e-6f), 1.0e-6f, 1.0f));
+        for (int j = 0; j < N; j++) {
+            const double share = (double)len[j] / rate / seconds;
+            // The Hadamard's 1 / sqrt(Q) is folded into the gain; the
+            // lowpass's Nyquist gain a / (2 - a) is this line's share of
+            // the tilt
+            g[j] = (float)(std::exp(lnGain * share) / std::sqrt((double)Q));
+            const double h = std::exp(lnTilt * share);
+            a[j] = (float)(2.0 * h / (1.0 + h));
+        }
+    }
+
+    // n <= min(kMaxBlock, minDelay()) samples of input to a stereo output
+    void process(const float* in, float* outL, float* outR, int n) {
+        float* out[2] = { outL, outR };
+        run<2>(in, out, n);
+    }
+
+    // The same to outs outputs (1 to kMaxOutputs), the first two of them
+    // what the stereo process() gives. Only the patterns asked for are
+    // summed.
+    void process(const float* in, float* const* out, int outs, int n) {
+        switch (outs) {
+            case 1:  run<1>(in, out, n); break;
+            case 2:  run<2>(in, out, n); break;
+            case 3:  run<3>(in, out, n); break;
+            case 4:  run<4>(in, out, n); break;
+            case 5:  run<5>(in, out, n); break;
+            case 6:  run<6>(in, out, n); break;
+            default: run<kMaxOutputs>(in, out, n); break;
+        }
+    }
+
+private:
+    template <int Outs>
+    void run(const float* in, float* const* out, int n) {
+        using namespace fdn_detail;
+
+        // Each line's stretch for the block, gathered into rows of lanes
+        alignas(16) float taps[kMaxBlock][(size_t)N];
+        for (int j = 0; j < N; j++) {
+            const size_t from = pos - len[j];
+            for (int i = 0; i < n; i++) taps[i][j] = ring[((from + (size_t)i) & mask) * N + (size_t)j];
+        }
+
+        Quad state[(size_t)Q], gain[(size_t)Q], coef[(size_t)Q], inSign[(size_t)Q], outSign[(size_t)Outs][(size_t)Q];
+        for (int q = 0; q < Q; q++) {
+            state[q]    = load(lp + 4 * q);
+            gain[q]     = load(g + 4 * q);
+            coef[q]     = load(a + 4 * q);
+            inSign[q]   = load(kInSign + 4 * q);
+            for (int o = 0; o < Outs; o++) outSign[o][q] = load(kOutSign[o] + 4 * q);
+        }
+        const Quad half = splat(0.5f);
+
+        for (int i = 0; i < n; i++) {
+            Quad x[(size_t)Q];
+            for (int q = 0; q < Q; q++) x[q] = load(taps[i] + 4 * q);
+
+            // Outputs: orthogonal sign patterns summed over the lines
+            for (int o = 0; o < Outs; o++) {
+                Quad acc = outSign[o][0] * x[0];
+                for (int q = 1; q < Q; q++) acc += outSign[o][q] * x[q];
+                out[o][i] = sum(acc);
+            }
+
+            // Damping and decay
+            for (int q = 0; q < Q; q++) {
+                state[q] += coef[q] * (x[q] - state[q]);
+                x[q] = gain[q] * state[q];
+            }
+            // Hadamard across quads, Householder within each
+            for (int h = 1; h < Q; h *= 2)
+                for (int k = 0; k < Q; k += 2 * h)
+                    for (int q = k; q < k + h; q++) {
+                        const Quad p = x[q], r = x[q + h];
+                        x[q]     = p + r;
+                        x[q + h] = p - r;
+                    }
+            const Quad v = splat(in[i] * kInGain);
+            float* row = ring.data() + ((pos + (size_t)i) & mask) * N;
+            for (int q = 0; q < Q; q++) {
+                x[q] -= half * splat(sum(x[q]));
+                store(row + 4 * q, x[q] + inSign[q] * v);
+            }
+        }
+
+        for (int q = 0; q < Q; q++) store(lp + 4 * q, state[q]);
+        pos = (pos + (size_t)n) & mask;
+    }
+
+    // Lengths at 48 kHz, all prime, 21 - 63 ms. Eight lines take every
+    // other one, so both sizes span the same range.
+    static constexpr int kLengths48k[16] = { 1031, 1151, 1277, 1399, 1523, 1657, 1789, 1931,
+                                             2053, 2203, 2341, 2477, 2617, 2749, 2887, 3041 };
+    static constexpr int baseLength(int j) { return kLengths48k[N == 16 ? j : 2 * j + 1]; }
+
+    // Input signs, and the output patterns: output o takes row o + 1 of
+    // the Sylvester Hadamard matrix, (-1)^popcount(j & (o + 1)) for line j,
+    // so every output is uncorrelated with every other. Outputs 0 and 1 are
+    // left and right.
+    static constexpr float kInSign[16] = { 1, -1, -1, 1, -1, 1, 1, 1, -1, -1, 1, -1, 1, 1, -1, 1 };
+    struct OutSigns {
+        float row[kMaxOutputs][(size_t)N] = {};
+        constexpr OutSigns() {
+            for (int o = 0; o < kMaxOutputs; o++)
+                for (int j = 0; j < N; j++) {
+                    int bits = 0;
+                    for (int b = j & (o + 1); b != 0; b >>= 1) bits += b & 1;
+                    row[o][j] = (bits & 1) ? -1.0f : 1.0f;
+                }
+        }
+        constexpr const float* operator[](int o) const { return row[o]; }
+    };
+    static constexpr OutSigns kOutSign {};
+    // 1 / sqrt(N): the input's power splits across the lines, and the
+    // plain sum over them on the way out makes up for it, so the output
+    // level does not depend on N
+    static constexpr float kInGain = N == 16 ? 0.25f : 0.35355339f;
+
+    std::vector<float> ring;           // rows of N, one per sample
+    size_t rows = 0, mask = 0, pos = 0;
+    size_t len[(size_t)N] = {};
+    double rate = 48000.0;
+    alignas(16) float lp[(size_t)N] = {};
+    alignas(16) float g[(size_t)N] = {};
+    alignas(16) float a[(size_t)N] = {};
+    float lastGain = -1.0f, lastNyquist = -1.0f, lastSeconds = -1.0f;
+};
+
+} // namespace sc
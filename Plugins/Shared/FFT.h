@@ -0,0 +1,117 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+// Complex radix-2 FFT on split real / imaginary arrays, for fast
+// convolution.
+//
+// forward() is decimation in frequency: natural order in, bit-reversed
+// order out. inverse() is decimation in time: bit-reversed in, natural out.
+// A product of two spectra is formed bin by bin and never cares which
+// order the bins are in, so convolution never pays for the permutation.
+// inverse(forward(x)) is size() * x.
+//
+// Every stage is one loop over contiguous twiddles per butterfly group,
+// which compilers vectorise once the groups are 4 or more wide.
+
+namespace sc {
+
+class FFT {
+public:
+    // size: a power of two, at least 2. Allocates.
+    void prepare(int size) {
+        n = size;
+        // Stage with half-width h uses twiddles [h, 2h): e^(-i pi j / h)
+        wr.assign((size_t)n, 0.0f);
+        wi.assign((size_t)n, 0.0f);
+        const double pi = 3.14159265358979323846;
+        for (int h = 1; h < n; h *= 2)
+            for (int j = 0; j < h; j++) {
+                wr[(size_t)(h + j)] = (float)std::cos(pi * j / h);
+                wi[(size_t)(h + j)] = (float)-std::sin(pi * j / h);
+            }
+    }
+
+    int size() const { return n; }
+
+    void forward(float* re, float* im) const {
+        for (int h = n / 2; h >= (n >= 4 ? 4 : 1); h /= 2) {
+            const float* cr = wr.data() + h;
+            const float* ci = wi.data() + h;
+            for (int k = 0; k < n; k += 2 * h) {
+                float* __restrict ar = re + k;
+                float* __restrict ai = im + k;
+                float* __restrict br = re + k + h;
+                float* __restrict bi = im + k + h;
+                for (int j = 0; j < h; j++) {
+                    const float dr = ar[j] - br[j], di = ai[j] - bi[j];
+                    ar[j] += br[j];
+                    ai[j] += bi[j];
+                    br[j] = dr * cr[j] - di * ci[j];
+                    bi[j] = dr * ci[j] + di * cr[j];
+                }
+            }
+        }
+        if (n >= 4) last4(re, im);
+    }
+
+    // Swapping real and imaginary parts on the way in and out turns the
+    // forward transform's kernel into the inverse's
+    void inverse(float* re, float* im) const {
+        float* const r = im;
+        float* const i = re;
+        if (n >= 4) first4(r, i);
+        for (int h = n >= 4 ? 4 : 1; h < n; h *= 2) {
+            const float* cr = wr.data() + h;
+            const float* ci = wi.data() + h;
+            for (int k = 0; k < n; k += 2 * h) {
+                float* __restrict ar = r + k;
+                float* __restrict ai = i + k;
+                float* __restrict br = r + k + h;
+                float* __restrict bi = i + k + h;
+                for (int j = 0; j < h; j++) {
+                    const float tr = br[j] * cr[j] - bi[j] * ci[j];
+                    const float ti = br[j] * ci[j] + bi[j] * cr[j];
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+
+private:
+    // The two narrowest stages (h = 2, 1; twiddles 1 and -i) as one 4-point
+    // pass: too narrow for the loops above to vectorise over the group
+    void last4(float* __restrict re, float* __restrict im) const {
+        for (int k = 0; k < n; k += 4) {
+            const float a0r = re[k]     + re[k + 2], a0i = im[k]     + im[k + 2];
+            const float a1r = re[k + 1] + re[k + 3], a1i = im[k + 1] + im[k + 3];
+            const float a2r = re[k]     - re[k + 2], a2i = im[k]     - im[k + 2];
+            const float a3r = im[k + 1] - im[k + 3], a3i = re[k + 3] - re[k + 1];
+            re[k]     = a0r + a1r;  im[k]     = a0i + a1i;
+            re[k + 1] = a0r - a1r;  im[k + 1] = a0i - a1i;
+            re[k + 2] = a2r + a3r;  im[k + 2] = a2i + a3i;
+            re[k + 3] = a2r - a3r;  im[k + 3] = a2i - a3i;
+        }
+    }
+    // Their mirror image (h = 1, 2) for the decimation in time
+    void first4(float* __restrict re, float* __restrict im) const {
+        for (int k = 0; k < n; k += 4) {
+            const float b0r = re[k]     + re[k + 1], b0i = im[k]     + im[k + 1];
+            const float b1r = re[k]     - re[k + 1], b1i = im[k]     - im[k + 1];
+            const float b2r = re[k + 2] + re[k + 3], b2i = im[k + 2] + im[k + 3];
+            const float b3r = im[k + 2] - im[k + 3], b3i = re[k + 3] - re[k + 2];
+            re[k]     = b0r + b2r;  im[k]     = b0i + b2i;
+            re[k + 1] = b1r + b3r;  im[k + 1] = b1i + b3i;
+            re[k + 2] = b0r - b2r;  im[k + 2] = b0i - b2i;
+            re[k + 3] = b1r - b3r;  im[k + 3] = b1i - b3i;
+        }
+    }
+
+    int n = 0;
+    std::vector<float> wr, wi;
+};
+
+} // namespace sc
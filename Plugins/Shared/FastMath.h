@@ -0,0 +1,129 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Branchless float approximations of the libm calls in the per-sample loops.
+//
+// Everything here is inline, uses only + * /, int conversion, abs/copysign,
+// selects and bit casts, so GCC/Clang/MSVC can vectorise a loop that calls them. Each
+// function documents its worst-case error over the stated domain; the
+// matching k*MaxError constants are what Tools/Bench/KernelBench checks
+// against (dense sweep vs double-precision libm).
+
+namespace sc {
+
+namespace fastmath_detail {
+    inline float asFloat(uint32_t u) { float f;    std::memcpy(&f, &u, sizeof f); return f; }
+
+    // floor() without the libm call (SSE2 has no round instruction, so
+    // std::floor blocks vectorisation there). Valid for |v| < 2^31.
+    inline float floorf(float v) {
+        const int32_t t = (int32_t)v;
+        return (float)(t - (int32_t)(v < (float)t));
+    }
+    inline float clampf(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    // sin(pi*z) for |z| <= 1/2 — odd degree-11 Taylor (truncation < 6e-8)
+    inline float sinPiPoly(float z) {
+        const float z2 = z * z;
+        float s = -7.37043094571435e-3f;                  // -pi^11/11!
+        s = s * z2 + 8.21458866111282e-2f;                //  pi^9/9!
+        s = s * z2 - 5.99264529320792e-1f;                // -pi^7/7!
+        s = s * z2 + 2.55016403987735e0f;                 //  pi^5/5!
+        s = s * z2 - 5.16771278004997e0f;                 // -pi^3/3!
+        s = s * z2 + 3.14159265358979e0f;                 //  pi
+        return s * z;
+    }
+
+    // 2^n for integral n in [-126, 127], built straight into the exponent field
+    inline float pow2i(float n) { return asFloat((uint32_t)((int32_t)n + 127) << 23); }
+
+    // e^r for |r| <= ln2/2, degree-7 Taylor (truncation < 6e-9)
+    inline float expPoly(float r) {
+        return 1.0f + r * (1.0f + r * (1.0f / 2.0f + r * (1.0f / 6.0f + r * (1.0f / 24.0f
+             + r * (1.0f / 120.0f + r * (1.0f / 720.0f + r * (1.0f / 5040.0f)))))));
+    }
+}
+
+// e^x. Max relative error 3e-7 for x in [-87, 88]; clamps outside that
+// (so never returns inf/denormal). Cody-Waite reduction keeps the error
+// flat across the whole range.
+constexpr float kExpMaxRelError = 3.0e-7f;
+inline float fastExp(float x) {
+    using namespace fastmath_detail;
+    x = clampf(x, -87.0f, 88.0f);
+    const float n = floorf(x * 1.44269504088896341f + 0.5f);
+    const float r = (x - n * 0.693359375f) + n * 2.12194440e-4f;   // ln2 split hi/lo
+    return expPoly(r) * pow2i(n);
+}
+
+// 2^x. Max relative error 3e-7 for x in [-126, 127]; clamps outside.
+constexpr float kExp2MaxRelError = 3.0e-7f;
+inline float fastExp2(float x) {
+    using namespace fastmath_detail;
+    x = clampf(x, -126.0f, 127.0f);
+    const float n = floorf(x + 0.5f);
+    return expPoly((x - n) * 0.693147180559945309f) * pow2i(n);
+}
+
+// base^x for a positive base fixed at the call site (pass log2(base)).
+// Relative error grows with |x * log2Base| because the product is rounded:
+// max 3e-7 + 6e-8 * |x * log2Base|, i.e. < 1e-6 for the ±12 dB and
+// 20..1600 ms mappings it replaces (9.3e-7 for 20 ms .. 30 s).
+constexpr float kPowMaxRelError = 1.0e-6f;
+inline float fastPow(float log2Base, float x) { return fastExp2(x * log2Base); }
+
+constexpr float kLog2Of10 = 3.32192809488736235f;
+constexpr float kLog2Of80 = 6.32192809488736235f;
+constexpr float kLog2Of1500 = 10.5507467853832431f;
+
+// tanh(x). Max absolute error 5e-7 over all finite x (13/6 rational,
+// clamped at ±7.9 where tanh rounds to ±1 in float).
+constexpr float kTanhMaxAbsError = 5.0e-7f;
+inline float fastTanh(float x) {
+    x = fastmath_detail::clampf(x, -7.90531110763549805f, 7.90531110763549805f);
+    const float x2 = x * x;
+    float p = -2.76076847742355e-16f;
+    p = p * x2 + 2.00018790482477e-13f;
+    p = p * x2 - 8.60467152213735e-11f;
+    p = p * x2 + 5.12229709037114e-08f;
+    p = p * x2 + 1.48572235717979e-05f;
+    p = p * x2 + 6.37261928875436e-04f;
+    p = p * x2 + 4.89352455891786e-03f;
+    float q = 1.19825839466702e-06f;
+    q = q * x2 + 1.18534705686654e-04f;
+    q = q * x2 + 2.26843463243900e-03f;
+    q = q * x2 + 4.89352518554385e-03f;
+    return x * p / q;
+}
+
+// sin(2*pi*p) for any finite phase p (in cycles). Max absolute error 2e-7
+// for |p| < 2^16. Exact reduction to [-1/4, 1/4] cycle by symmetry, then
+// an odd degree-11 polynomial.
+constexpr float kSin2PiMaxAbsError = 2.0e-7f;
+inline float fastSin2Pi(float p) {
+    using namespace fastmath_detail;
+    const float y  = 2.0f * (p - floorf(p + 0.5f));              // [-1, 1) half-cycles
+    const float ay = std::abs(y);
+    return sinPiPoly(std::copysign(std::min(ay, 1.0f - ay), y));  // sin(pi(1-y)) = sin(pi y)
+}
+
+// cos(2*pi*p), same bound as fastSin2Pi: cos(2 pi y) = sin(pi (1/2 - 2|y|)).
+inline float fastCos2Pi(float p) {
+    using namespace fastmath_detail;
+    const float y = p - floorf(p + 0.5f);                        // [-1/2, 1/2) cycles
+    return sinPiPoly(0.5f - 2.0f * std::abs(y));
+}
+
+// x mod len into [0, len] for len > 0 and |x / len| < 2^31 — negative x
+// wraps the same way as fmod + add. Can return exactly len when x is a tiny
+// negative number; callers that index with it must mask or clamp.
+inline float wrapPhase(float x, float len) { return x - len * fastmath_detail::floorf(x * (1.0f / len)); }
+
+// a and b are the same float bit for bit: the exact "has this setting
+// changed" test, without an == on floats (-Wfloat-equal)
+inline bool sameBits(float a, float b) { return std::memcmp(&a, &b, sizeof a) == 0; }
+
+} // namespace sc
@@ -0,0 +1,305 @@
+#pragma once
+#include "Interpolators.h"
+#include "SampleStore.h"
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Delay line read at fractional delays through one of the kernels in
+// Interpolators.h, chosen per call at compile time: read<interp::Sinc8>(d).
+//
+// The buffer carries a guard region past its end that mirrors the first
+// kGuard samples, so the taps for any delay - and the taps for a whole
+// block of up to kMaxBlock reads - sit in contiguous memory. A read wraps its
+// start index once with a compare instead of taking a modulo per tap.
+//
+// Delays are clamped to what the kernel's taps can reach: from
+// kTaps / 2 + kShift (every tap already written) to size() - kTaps / 2.
+//
+// Block reads return what read() would give sample by sample while pushing,
+// as long as the block reads nothing written during it (see canReadAhead()).
+// Kernels with State (the allpass) take one per read head.
+//
+// Store is the sample format the line keeps (SampleStore.h). Anything but
+// Float32 is turned back into float32 as it is read: a block read converts
+// the whole stretch its taps span in one pass, then runs the kernel on
+// that, so it costs one conversion per sample read rather than per tap.
+//
+// Paged lines (initPaged) are for long delays: the memory for the longest
+// length is reserved up front as fixed-size pages, each with its own guard
+// mirroring the start of the next, and setLength() picks how many of them
+// the ring runs through. Nothing is zeroed; a page is first touched when
+// the write head reaches it, and reads further back than anything written
+// since see silence. The ring changes size when the write head crosses a
+// page boundary - new pages go in just ahead of it, dropped pages are the
+// oldest - so the history behind the write head always stays in order.
+// setLength() never allocates.
+
+namespace sc {
+
+template <class Store = store::Float32>
+class BasicFractionalDelay {
+public:
+    static constexpr int kMaxTaps = 8, kMaxBlock = 128, kGuard = kMaxBlock + kMaxTaps;
+    using Word = typename Store::Word;
+
+    // n samples in one zeroed page
+    void init(int n) {
+        flat.assign((size_t)(n + kGuard), Store::encode(0.0f));
+        pool.reset();
+        pages.assign(1, flat.data());
+        spare.clear();
+        pageShift = 30; pageMask = (1 << 30) - 1; pageLen = n;
+        ring = length = maxLength = n;
+        wantPages = 1;
+        pageStart = 0;
+        filled = n;
+        enterPage();
+    }
+
+    // Pages of 2^pageLog2 samples, enough for setLength(maxLen). Call
+    // setLength() before the first push.
+    void initPaged(int maxLen, int pageLog2 = 14) {
+        const int page = 1 << pageLog2, count = (maxLen + page - 1) / page + 1;
+        flat.clear();
+        flat.shrink_to_fit();
+        pool.reset(new Word[(size_t)count * (size_t)(page + kGuard)]);   // left as the OS maps it
+        pages.clear();
+        pages.reserve((size_t)count);
+        spare.clear();
+        spare.reserve((size_t)count);
+        for (int k = count - 1; k >= 0; k--) spare.push_back(pool.get() + (size_t)k * (size_t)(page + kGuard));
+        pageShift = pageLog2; pageMask = page - 1; pageLen = page;
+        ring = length = 0;
+        maxLength = maxLen;
+        wantPages = 0;
+        pageStart = off = 0;
+        filled = 0;
+        head = tail = nullptr;
+    }
+
+    // Paged lines: the longest delay wanted, up to initPaged's maxLen. The
+    // ring keeps a page beyond it. Longer takes effect at the next page
+    // boundary, at once on a fresh line; shorter only once the length has
+    // halved, so automation swinging back and forth doesn't keep dropping
+    // history it will want again.
+    void setLength(int n) {
+        length = std::min(n, maxLength);
+        const int need = (length + pageLen - 1) / pageLen + 1, have = (int)pages.size();
+        wantPages = need > have || need * 2 <= have ? need : have;
+        if (have == 0) { resize(); enterPage(); }
+    }
+
+    // The longest delay a read reaches
+    int size() const { return std::min(length, ring); }
+
+    // Samples of history the line holds, reachable or not
+    int capacity() const { return ring; }
+
+    void push(float v) {
+        const Word w = Store::encode(v);
+        head[off] = w;
+        if (off < kGuard) tail[off] = w;
+        if (++off == pageLen) turnPage();
+    }
+
+    // d = 1 is the newest sample
+    template <class K = interp::Hermite>
+    float read(float d, typename K::State& st) const {
+        const Split s = split<K>(d);
+        const int valid = written();
+        if (s.whole + K::kTaps / 2 > valid) return readUnwritten<K>(writePos(), s, valid, st);
+        const Word* w = at(first<K>(writePos(), s.whole));
+        if constexpr (kFloat) return K::apply(w, s.frac, st);
+        float y[K::kTaps];
+        Store::decode(w, y, K::kTaps);
+        return K::apply(y, s.frac, st);
+    }
+    template <class K = interp::Hermite>
+    float read(float d) const {
+        static_assert(std::is_empty<typename K::State>::value, "this kernel needs a State per read head");
+        typename K::State st;
+        return read<K>(d, st);
+    }
+
+    // n reads at a delay that holds still: the taps slide along contiguous
+    // memory with one fractional position, so stateless kernels vectorise
+    template <class K = interp::Hermite>
+    void read(float d, float* out, int n, typename K::State& st) const {
+        const Split s = split<K>(d);
+        const int valid = written();
+        if (s.whole + K::kTaps / 2 > valid) {
+            for (int i = 0; i < n; i++)
+                out[i] = readUnwritten<K>(writePos() + i, s, std::min(valid + i, ring), st);
+            return;
+        }
+        const Word* w = at(first<K>(writePos(), s.whole));
+        if constexpr (kFloat) {
+            for (int i = 0; i < n; i++)
+                out[i] = K::apply(w + i, s.frac, st);
+        } else {
+            float y[kGuard];
+            for (int from = 0; from < n; from += kMaxBlock) {
+                const int m = std::min(kMaxBlock, n - from);
+                Store::decode(w + from, y, m + K::kTaps - 1);
+                for (int i = 0; i < m; i++)
+                    out[from + i] = K::apply(y + i, s.frac, st);
+            }
+        }
+    }
+
+    // n reads, one delay per sample
+    template <class K = interp::Hermite>
+    void read(const float* d, float* out, int n, typename K::State& st) const {
+        for (int from = 0; from < n; from += kMaxBlock)
+            readSpan<K>(d + from, out + from, from, std::min(kMaxBlock, n - from), st);
+    }
+
+    // True when a block of n reads at delays of at least minDelay can be
+    // taken before the block's pushes
+    template <class K = interp::Hermite>
+    bool canReadAhead(float minDelay, int n) const {
+        return n <= kMaxBlock && split<K>(minDelay).whole >= n + K::kTaps / 2 - 1;
+    }
+
+private:
+    static constexpr bool kFloat = std::is_same<Word, float>::value;
+
+    struct Split { int whole; float frac; };
+
+    // Word at ring index p, with the guard of its page after it
+    const Word* at(int p) const { return pages[(size_t)(p >> pageShift)] + (p & pageMask); }
+
+    // Per-sample delays for samples [from, from + n) of a block read: sample
+    // i's taps start (i - whole) past the write position, so when those
+    // starts stay within a guard's length of each other the stretch they
+    // cover sits in one page and its guard - found once, and converted once
+    // for compact stores. Delays that jump further are looked up per read.
+    template <class K>
+    void readSpan(const float* d, float* out, const int from, const int n, typename K::State& st) const {
+        Split s[kMaxBlock];
+        int lo = 0, hi = 0, oldest = 0;
+        for (int i = 0; i < n; i++) {
+            s[i] = split<K>(d[i]);
+            const int o = from + i - s[i].whole;
+            lo = i == 0 ? o : std::min(lo, o);
+            hi = i == 0 ? o : std::max(hi, o);
+            oldest = std::max(oldest, s[i].whole);
+        }
+        const int valid = written();
+        if (oldest + K::kTaps / 2 > valid) {
+            for (int i = 0; i < n; i++)
+                out[i] = readUnwritten<K>(writePos() + from + i, s[i], std::min(valid + from + i, ring), st);
+            return;
+        }
+        const int span = hi - lo + K::kTaps;
+        if (span > kGuard) {
+            for (int i = 0; i < n; i++) {
+                const Word* w = at(first<K>(writePos() + from + i, s[i].whole));
+                if constexpr (kFloat) out[i] = K::apply(w, s[i].frac, st);
+                else {
+                    float y[K::kTaps];
+                    Store::decode(w, y, K::kTaps);
+                    out[i] = K::apply(y, s[i].frac, st);
+                }
+            }
+            return;
+        }
+        const Word* w = at(first<K>(writePos() + lo, 0));
+        if constexpr (kFloat) {
+            for (int i = 0; i < n; i++)
+                out[i] = K::apply(w + (from + i - s[i].whole - lo), s[i].frac, st);
+        } else {
+            float y[kGuard];
+            Store::decode(w, y, span);
+            for (int i = 0; i < n; i++)
+                out[i] = K::apply(y + (from + i - s[i].whole - lo), s[i].frac, st);
+        }
+    }
+
+    // A read reaching further back than the valid samples behind write
+    // position w: those taps are silence
+    template <class K>
+    float readUnwritten(int w, Split s, int valid, typename K::State& st) const {
+        float y[K::kTaps];
+        for (int j = 0; j < K::kTaps; j++) {
+            const int age = s.whole + K::kTaps / 2 - j;
+            int p = w - age;
+            p = p < 0 ? p + ring : p >= ring ? p - ring : p;
+            y[j] = age > valid ? 0.0f : Store::decode(*at(p));
+        }
+        return K::apply(y, s.frac, st);
+    }
+
+    template <class K>
+    Split split(float d) const {
+        const float ds    = std::min(std::max(d, K::kTaps / 2 + K::kShift), (float)(size() - K::kTaps / 2)) - K::kShift;
+        const int   whole = (int)ds;
+        return { whole, ds - (float)whole };
+    }
+
+    // Index of the oldest tap around integer delay whole, with the write
+    // position at w
+    template <class K>
+    int first(int w, int whole) const {
+        const int p = w - whole - K::kTaps / 2;
+        return p < 0 ? p + ring : p;
+    }
+
+    int writePos() const { return pageStart + off; }
+
+    // Samples behind the write head that hold what was pushed
+    int written() const { return std::min(filled + off, ring); }
+
+    // The write head has filled its page: the ring changes size if
+    // setLength() asked for it, and the head moves on
+    void turnPage() {
+        filled = std::min(filled + pageLen, ring);
+        pageStart += pageLen;
+        if (pageStart == ring) pageStart = 0;
+        if (wantPages != (int)pages.size()) resize();
+        enterPage();
+    }
+
+    // The page under the write head, and the guard before it that mirrors
+    // its start
+    void enterPage() {
+        const int page = pageStart >> pageShift;
+        off  = 0;
+        head = pages[(size_t)page];
+        tail = pages[page == 0 ? pages.size() - 1 : (size_t)page - 1] + pageLen;
+    }
+
+    // Rotate the page the write head is entering to the front, then add
+    // pages ahead of it or drop the oldest from it
+    void resize() {
+        const int have = (int)pages.size();
+        std::rotate(pages.begin(), pages.begin() + (pageStart >> pageShift), pages.end());
+        if (wantPages > have) {
+            const auto from = spare.end() - (wantPages - have);
+            pages.insert(pages.begin(), from, spare.end());
+            spare.erase(from, spare.end());
+        } else {
+            spare.insert(spare.end(), pages.begin(), pages.begin() + (have - wantPages));
+            pages.erase(pages.begin(), pages.begin() + (have - wantPages));
+        }
+        ring      = wantPages * pageLen;
+        pageStart = 0;
+        filled    = std::min(filled, ring);
+    }
+
+    std::vector<Word> flat;          // init()
+    std::unique_ptr<Word[]> pool;    // initPaged()
+    std::vector<Word*> pages, spare; // the ring, in order; pages not in it
+    int pageShift = 30, pageMask = (1 << 30) - 1, pageLen = 0;
+    int ring = 0, length = 0, maxLength = 0, wantPages = 0;
+    Word* head = nullptr;            // the page being written
+    Word* tail = nullptr;            // the guard after the page before it
+    int pageStart = 0, off = 0;      // where head sits in the ring; the write head's offset in it
+    int filled = 0;                  // written() as of head's start
+};
+
+using FractionalDelay = BasicFractionalDelay<>;
+
+} // namespace sc
@@ -0,0 +1,34 @@
+#pragma once
+#include <algorithm>
+
+namespace sc {
+
+// Samples per control chunk. processBlock walks the buffer in chunks of at
+// most this many samples and refreshes every ramp once per chunk, so a ramp
+// that finishes mid-block drops back to the steady path at the next chunk.
+constexpr int kRampChunk = 128;
+
+// Block-rate view of a juce::SmoothedValue. fill() either records the steady
+// value (no smoothing in progress) or writes the next n smoothed values into
+// an aligned array, so per-sample loops never call getNextValue() and the
+// steady case can run a loop with every derived coefficient hoisted.
+struct ParamRamp {
+    alignas(32) float ramp[kRampChunk];
+    float steady = 0.0f;
+    bool  moving = false;
+
+    template <typename Smoothed>
+    void fill(Smoothed& sm, int n) {
+        moving = sm.isSmoothing();
+        if (!moving) { steady = sm.getTargetValue(); return; }
+        for (int i = 0; i < n; i++) ramp[i] = sm.getNextValue();
+        steady = ramp[n - 1];
+    }
+
+    float operator[](int i) const { return moving ? ramp[i] : steady; }
+};
+
+template <typename... Ramps>
+inline bool anyMoving(const Ramps&... r) { return (r.moving || ...); }
+
+} // namespace sc
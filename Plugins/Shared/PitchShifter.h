@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Stereo granular pitch shifter: 2 to 4 read heads sweep through a ring of
+// recent input faster than it is written, each faded in and out by a Hann
+// window, equally spaced in phase so the windows always sum to the same
+// gain. More heads overlap more grains and smooth out the modulation the
+// crossfades leave.
+//
+// Everything runs on one 32-bit phase accumulator, a full turn per grain.
+// A head's lag behind the write position is its phase times the grain
+// length, taken in 32.32 fixed point, so its read position comes out as an
+// integer index and a fraction with no floating-point wrap; its window is
+// read from a table by the phase's top bits. A head jumps back a whole
+// grain where its window is zero.
+//
+// process() gives outputs for the next n samples before they are pushed:
+// heads stay at least minLag behind, so n may be up to minLag - 1.
+
+namespace sc {
+
+class PitchShifter {
+public:
+    static constexpr int kMaxHeads = 4;
+
+    // ringSize: a power of two longer than minLag + grain + 1. Allocates.
+    void prepare(int ringSize, int grain, int minLag) {
+        ring.assign((size_t)ringSize * 2, 0.0f);
+        mask = (size_t)ringSize - 1;
+        grainLength = (uint32_t)grain;
+        minLagQ = (uint64_t)minLag << 32;
+        const double pi = 3.14159265358979323846;
+        for (int i = 0; i <= kTableSize; i++)
+            window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * pi * i / kTableSize));
+        setRatio(2.0f);
+        setHeads(2);
+        reset();
+    }
+
+    void reset() {
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        pos = 0;
+        phase = 0;
+    }
+
+    // Above 1: how much faster the heads read than the ring is written
+    void setRatio(float ratio) {
+        inc = (uint32_t)std::llround((double)(ratio - 1.0f) * 4294967296.0 / grainLength);
+    }
+
+    void setHeads(int n) {
+        heads = std::clamp(n, 2, kMaxHeads);
+        for (int k = 0; k < heads; k++)
+            offset[k] = (uint32_t)(((uint64_t)k << 32) / (uint64_t)heads);
+        // Hann windows spaced evenly round a turn sum to heads / 2
+        gain = 2.0f / (float)heads;
+    }
+
+    void push(float l, float r) {
+        ring[2 * pos]     = l;
+        ring[2 * pos + 1] = r;
+        pos = (pos + 1) & mask;
+    }
+
+    void process(float* outL, float* outR, int n) {
+        switch (heads) {
+            case 2:  run<2>(outL, outR, n); break;
+            case 3:  run<3>(outL, outR, n); break;
+            default: run<4>(outL, outR, n); break;
+        }
+    }
+
+private:
+    static constexpr int kTableBits = 9, kTableSize = 1 << kTableBits;
+
+    template <int H>
+    void run(float* outL, float* outR, int n) {
+        const float* buf = ring.data();
+        for (int i = 0; i < n; i++) {
+            const uint64_t here = (uint64_t)(pos + (size_t)i) << 32;
+            float l = 0.0f, r = 0.0f;
+            for (int k = 0; k < H; k++) {
+                const uint32_t p = phase + offset[k];
+                // Lag runs from minLag + grain down to minLag over a turn
+                const uint64_t at = here - minLagQ - (uint64_t)grainLength * (uint32_t)(0u - p);
+                const size_t i0 = (size_t)(at >> 32) & mask, i1 = (i0 + 1) & mask;
+                const float f = (float)((uint32_t)at >> 8) * (1.0f / 16777216.0f);
+                const uint32_t w0 = p >> (32 - kTableBits);
+                const float wf = (float)((p >> (32 - kTableBits - 16)) & 0xFFFF) * (1.0f / 65536.0f);
+                const float w = window[w0] + wf * (window[w0 + 1] - window[w0]);
+                l += w * (buf[2 * i0]     + f * (buf[2 * i1]     - buf[2 * i0]));
+                r += w * (buf[2 * i0 + 1] + f * (buf[2 * i1 + 1] - buf[2 * i0 + 1]));
+            }
+            outL[i] = gain * l;
+            outR[i] = gain * r;
+            phase += inc;
+        }
+    }
+
+    std::vector<float> ring;    // interleaved L / R
+    size_t mask = 0, pos = 0;
+    uint32_t grainLength = 1;
+    uint64_t minLagQ = 0;
+    uint32_t phase = 0, inc = 0;
+    int heads = 2;
+    uint32_t offset[kMaxHeads] = {};
+    float gain = 1.0f;
+    float window[kTableSize + 1] = {};
+};
+
+} // namespace sc
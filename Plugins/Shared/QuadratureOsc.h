@@ -0,0 +1,98 @@
+#pragma once
+#include <cmath>
+
+// Sine / cosine LFO by recursion: a unit phasor turned through a fixed
+// angle every sample, one complex multiply and no trig once the frequency
+// is set. fill() runs four phasors a sample apart, each turned four samples
+// at a time, so the multiplies do not wait on each other.
+//
+// The phasor is kept in double, so rounding barely moves its frequency;
+// what little its length drifts is pulled back to 1 at the end of every
+// fill() and advance() with one Newton step.
+
+namespace sc {
+
+class QuadratureOsc {
+public:
+    // Cycles per sample. Not for every block: takes a cos and a sin.
+    void setFrequency(double cyclesPerSample) {
+        freq = cyclesPerSample;
+        const double w = kTwoPi * freq;
+        stepC = std::cos(w);
+        stepS = std::sin(w);
+        step4C = std::cos(4.0 * w);
+        step4S = std::sin(4.0 * w);
+        jumpN = -1;
+    }
+
+    // Cycles from the start of a sine
+    void setPhase(double cycles) {
+        c = std::cos(kTwoPi * cycles);
+        s = std::sin(kTwoPi * cycles);
+    }
+
+    float sin() const { return (float)s; }
+    float cos() const { return (float)c; }
+
+    // The next n samples of sine and cosine, then moves on by n
+    void fill(float* sinOut, float* cosOut, int n) {
+        int i = 0;
+        if (n >= 4) {
+            double lc[4] = { c }, ls[4] = { s };
+            for (int k = 1; k < 4; k++) {
+                lc[k] = lc[k - 1] * stepC - ls[k - 1] * stepS;
+                ls[k] = ls[k - 1] * stepC + lc[k - 1] * stepS;
+            }
+            for (; i + 4 <= n; i += 4)
+                for (int k = 0; k < 4; k++) {
+                    sinOut[i + k] = (float)ls[k];
+                    cosOut[i + k] = (float)lc[k];
+                    const double nc = lc[k] * step4C - ls[k] * step4S;
+                    ls[k] = ls[k] * step4C + lc[k] * step4S;
+                    lc[k] = nc;
+                }
+            c = lc[0];
+            s = ls[0];
+        }
+        for (; i < n; i++) {
+            sinOut[i] = (float)s;
+            cosOut[i] = (float)c;
+            rotate(stepC, stepS);
+        }
+        normalise();
+    }
+
+    // Moves on by n samples without output. The turn for the last n is
+    // kept, so a steady block size costs no trig.
+    void advance(int n) {
+        if (n != jumpN) {
+            jumpN = n;
+            jumpC = std::cos(kTwoPi * freq * n);
+            jumpS = std::sin(kTwoPi * freq * n);
+        }
+        rotate(jumpC, jumpS);
+        normalise();
+    }
+
+private:
+    static constexpr double kTwoPi = 6.283185307179586476925;
+
+    void rotate(double rc, double rs) {
+        const double nc = c * rc - s * rs;
+        s = s * rc + c * rs;
+        c = nc;
+    }
+    void normalise() {
+        const double g = 1.5 - 0.5 * (c * c + s * s);
+        c *= g;
+        s *= g;
+    }
+
+    double c = 1.0, s = 0.0;
+    double stepC = 1.0, stepS = 0.0, step4C = 1.0, step4S = 0.0;
+    double freq = 0.0;
+    int    jumpN = -1;
+    double jumpC = 1.0, jumpS = 0.0;
+};
+
+} // namespace sc
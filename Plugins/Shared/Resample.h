@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Band-limited sample-rate conversion of a whole buffer at once, for
+// material loaded off the audio thread (impulse responses).
+//
+// Kaiser-windowed sinc cut off at 0.47 of the lower of the two rates,
+// 16 zero crossings each side. The kernel is tabulated 256 times per zero
+// crossing and interpolated linearly between. Anything the filter rings
+// past the last input sample is dropped: the output is
+// ceil(n * toRate / fromRate) samples long.
+
+namespace sc {
+
+namespace resample_detail {
+    inline double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int i = 1; i < 64 && term > 1e-12 * sum; i++) {
+            const double h = x / (2.0 * i);
+            term *= h * h;
+            sum  += term;
+        }
+        return sum;
+    }
+}
+
+inline std::vector<float> resample(const float* in, size_t n, double fromRate, double toRate) {
+    // Rates that agree to a part in 10^9 are the same rate
+    if (std::abs(toRate - fromRate) <= 1e-9 * fromRate || n == 0) return std::vector<float>(in, in + n);
+
+    constexpr int    kCrossings = 16, kRes = 256;
+    constexpr double kBeta = 9.0;
+    const double pi = 3.14159265358979323846;
+    const double ratio  = toRate / fromRate;
+    const double cutoff = 0.47 * std::min(1.0, ratio);       // cycles per input sample
+    const double halfWidth = kCrossings / (2.0 * cutoff);    // input samples
+    const double step = 1.0 / (2.0 * cutoff * kRes);         // input samples per table entry
+
+    // k(t) for t = i * step, t in [0, halfWidth]
+    std::vector<float> kernel((size_t)(kCrossings * kRes) + 2, 0.0f);
+    for (size_t i = 0; i + 1 < kernel.size(); i++) {
+        const double t = (double)i * step, u = t / halfWidth;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(pi * x) / (pi * x);
+        const double w = u < 1.0 ? resample_detail::besselI0(kBeta * std::sqrt(1.0 - u * u)) / resample_detail::besselI0(kBeta) : 0.0;
+        kernel[i] = (float)(2.0 * cutoff * sinc * w);
+    }
+
+    std::vector<float> out((size_t)std::ceil((double)n * ratio));
+    for (size_t k = 0; k < out.size(); k++) {
+        const double t = (double)k / ratio;
+        const long first = std::max(0L, (long)std::ceil(t - halfWidth));
+        const long last  = std::min((long)n - 1, (long)std::floor(t + halfWidth));
+        double acc = 0.0;
+        for (long i = first; i <= last; i++) {
+            const double p = std::abs(t - (double)i) / step;
+            const size_t j = (size_t)p;
+            if (j + 1 >= kernel.size()) continue;
+            const float f = (float)(p - (double)j);
+            acc += in[i] * (kernel[j] + f * (kernel[j + 1] - kernel[j]));
+        }
+        out[k] = (float)acc;
+    }
+    return out;
+}
+
+} // namespace sc
@@ -0,0 +1,111 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(__F16C__)
+  #include <immintrin.h>
+#endif
+
+// Sample formats a delay line can keep its contents in (see
+// BasicFractionalDelay in FractionalDelay.h). Each converts one sample on
+// the way in and a run of them on the way out, so a block read turns the
+// stretch it touches back into float32 in one loop.
+//
+//   format    bytes   noise added (KernelBench: ECHODLY-style loop at
+//                     feedback 0.88, -12 dBFS noise in, ~-18 dBFS out)
+//   Float32     4     none
+//   Half        2     72 dB below the signal (11-bit significand)
+//   Int16       2     -89 dBFS whatever the level; clips at +-kFullScale
+//
+// Half keeps a constant ratio to the signal, and its subnormals carry it
+// down to about -140 dBFS, so tails fade out smoothly. Int16 has a fixed
+// step, so quiet tails lose resolution first, but it costs nothing to
+// convert.
+
+namespace sc {
+namespace store {
+
+struct Float32 {
+    using Word = float;
+    static Word  encode(float x) { return x; }
+    static float decode(Word w) { return w; }
+    static void  decode(const Word* w, float* out, int n) { std::memcpy(out, w, sizeof(float) * (size_t)n); }
+};
+
+// IEEE binary16, rounded to nearest even. With F16C (-mf16c, or an -march
+// that has it) the conversions are single instructions, and blocks decode
+// eight at a time.
+struct Half {
+    using Word = std::uint16_t;
+
+    static Word encode(float x) {
+#if defined(__F16C__)
+        return (Word)_cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT);
+#else
+        // After F. Giesen, "float_to_half_fast3_rtne"
+        const std::uint32_t f32Inf = 255u << 23, f16Max = (127u + 16u) << 23;
+        const float denormMagic = bits(((127u - 15u) + (23u - 10u) + 1u) << 23);
+        std::uint32_t u = bits(x);
+        const std::uint32_t sign = u & 0x80000000u;
+        u ^= sign;
+        Word h;
+        if (u >= f16Max)
+            h = u > f32Inf ? 0x7e00 : 0x7c00;                                    // NaN, or overflow to Inf
+        else if (u < (113u << 23))
+            h = (Word)(bits(bits(u) + denormMagic) - bits(denormMagic));          // subnormal or zero
+        else {
+            const std::uint32_t mantOdd = (u >> 13) & 1u;
+            u += ((std::uint32_t)(15 - 127) << 23) + 0xfffu + mantOdd;
+            h = (Word)(u >> 13);
+        }
+        return (Word)(h | (sign >> 16));
+#endif
+    }
+
+    static float decode(Word h) {
+#if defined(__F16C__)
+        return _cvtsh_ss(h);
+#else
+        const float magic = bits(113u << 23);
+        const std::uint32_t shiftedExp = 0x7c00u << 13;
+        std::uint32_t u = (std::uint32_t)(h & 0x7fffu) << 13;
+        const std::uint32_t exp = u & shiftedExp;
+        u += (std::uint32_t)(127 - 15) << 23;
+        if (exp == shiftedExp) u += (std::uint32_t)(128 - 16) << 23;   // Inf / NaN
+        else if (exp == 0)     u = bits(bits(u + (1u << 23)) - magic); // subnormal
+        return bits(u | ((std::uint32_t)(h & 0x8000u) << 16));
+#endif
+    }
+
+    static void decode(const Word* w, float* out, int n) {
+        int i = 0;
+#if defined(__F16C__)
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i))));
+#endif
+        for (; i < n; i++) out[i] = decode(w[i]);
+    }
+
+private:
+    static std::uint32_t bits(float f)         { std::uint32_t u; std::memcpy(&u, &f, 4); return u; }
+    static float         bits(std::uint32_t u) { float f; std::memcpy(&f, &u, 4); return f; }
+};
+
+// Signed 16-bit over +-kFullScale: 12 dB of headroom above 0 dBFS for
+// input plus feedback, clipped beyond
+struct Int16 {
+    using Word = std::int16_t;
+    static constexpr float kFullScale = 4.0f;
+
+    static Word encode(float x) {
+        const float s = x * (32767.0f / kFullScale);
+        return (Word)std::lrint(s < -32767.0f ? -32767.0f : s > 32767.0f ? 32767.0f : s);
+    }
+    static float decode(Word w) { return (float)w * (kFullScale / 32767.0f); }
+    static void  decode(const Word* w, float* out, int n) {
+        for (int i = 0; i < n; i++) out[i] = (float)w[i] * (kFullScale / 32767.0f);
+    }
+};
+
+} // namespace store
+} // namespace sc
@@ -0,0 +1,61 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Block-level silence tracking, so an idle processor can skip its
+// per-sample work.
+//
+// After each processed block the processor reports its input peak and the
+// peak of whatever carries its tail (the wet signal of a reverb, the taps
+// and sends of a delay). Once both have stayed under kSilence for hold
+// samples - long enough that nothing louder is left anywhere inside - the
+// gate falls asleep. A sleeping processor leaves its state as it is and
+// only checks each block's input: it wakes, and processes that same block,
+// as soon as the input gets louder than the quietest it fell asleep at
+// (any non-zero sample, after digital silence).
+
+namespace sc {
+
+// -100 dBFS
+constexpr float kSilence = 1.0e-5f;
+
+inline float blockPeak(const float* x, int n) {
+    float p = 0.0f;
+    for (int i = 0; i < n; i++) p = std::max(p, std::abs(x[i]));
+    return p;
+}
+
+inline float blockPeak(const float* const* channels, int numChannels, int n) {
+    float p = 0.0f;
+    for (int c = 0; c < numChannels; c++) p = std::max(p, blockPeak(channels[c], n));
+    return p;
+}
+
+class SleepGate {
+public:
+    void reset() { quietFor = 0; floor = 0.0f; sleeping = false; }
+
+    // Before a block: true when it can be skipped. A louder input wakes
+    // the gate.
+    bool sleep(float inPeak) {
+        if (sleeping && inPeak > std::min(2.0f * floor, kSilence)) reset();
+        return sleeping;
+    }
+
+    // After a processed block of n samples
+    void update(float inPeak, float tailPeak, int n, int hold) {
+        if (inPeak >= kSilence || tailPeak >= kSilence) { quietFor = 0; floor = 0.0f; return; }
+        floor    = std::max(floor, inPeak);
+        quietFor = std::min(quietFor + n, hold);
+        sleeping = quietFor >= hold;
+    }
+
+    bool asleep() const { return sleeping; }
+
+private:
+    int   quietFor = 0;      // samples, up to hold
+    float floor    = 0.0f;   // loudest input since the quiet began
+    bool  sleeping = false;
+};
+
+} // namespace sc
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+
+// Lock-free hand-over of a large object from one producer thread to one
+// consumer thread (typically a background builder and the audio thread).
+//
+// Three slots: the producer owns back(), the consumer owns front(), and the
+// third sits in between. publish() swaps the finished back slot into the
+// middle; acquire() swaps a freshly published middle slot to the front.
+// Neither side ever waits, allocates or sees a slot the other is using.
+
+namespace sc {
+
+template <class T>
+class TripleBuffer {
+public:
+    // ── Producer side ──
+    T&   back() { return slots[backIndex]; }
+    void publish() { backIndex = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel) & kIndex; }
+
+    // ── Consumer side ──
+    // Returns true when a newer slot was taken over
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr int kFresh = 4, kIndex = 3;
+    T   slots[3];
+    int frontIndex = 0, backIndex = 1;
+    std::atomic<int> middle { 2 };
+};
+
+} // namespace sc
@@ -0,0 +1,367 @@
+// Headless processBlock benchmark for the Sound Capsule processors.
+//
+// One executable is built per plugin (see Tools/Bench/CMakeLists.txt); each
+// links that plugin's processor sources and drives it through
+// createPluginFilter(), so nothing here knows about a specific processor.
+// No editor is ever created.
+//
+//   DreamverbBench --rates 48000 --blocks 64,512 --signals noise --counters
+//
+// Results are written as JSON to stdout (or --out <file>).
+//
+// --render <file.wav> instead processes --seconds of the first rate / block /
+// signal with one instance and writes the output as 32-bit float WAV, so
+// two builds can be A/B compared (same options, same input, same sweep).
+//
+// --state <file.xml> loads a saved processor state (the XML the plugin
+// writes into its chunk) before the --param overrides, for settings that
+// are not parameters, such as Dreamverb's impulse response file.
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef SC_BENCH_PLUGIN_NAME
+ #define SC_BENCH_PLUGIN_NAME "Unknown"
+#endif
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<double> rates   { 44100.0, 48000.0, 96000.0, 192000.0 };
+    std::vector<int>    blocks  { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    std::vector<std::string> signals { "silence", "noise", "sine", "sweep" };
+    std::vector<std::pair<std::string, float>> params;
+    double seconds   = 2.0;
+    double warmup    = 0.25;
+    int    instances = 1;
+    int    channels  = 2;
+    bool   counters  = false;
+    std::string out, render, state;
+};
+
+struct RunResult {
+    double sampleRate = 0.0;
+    int    blockSize = 0;
+    std::string signal;
+    double nsPerSample = 0.0, realtimeFactor = 0.0;
+    double p50 = 0.0, p99 = 0.0, p999 = 0.0, maxNs = 0.0;
+    bool   hasCounters = false;
+    PerfCounters::Sample counters;
+};
+
+// ── Argument parsing ────────────────────────────────────────────────────
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t comma = s.find(',', start);
+        if (comma == std::string::npos) comma = s.size();
+        if (comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+[[noreturn]] void usage(const char* exe) {
+    std::fprintf(stderr,
+        "usage: %s [--rates r1,r2..] [--blocks b1,b2..] [--signals silence,noise,sine,sweep]\n"
+        "          [--seconds s] [--warmup s] [--instances n] [--channels n]\n"
+        "          [--state file.xml] [--param id=value].. [--counters] [--out file.json]\n"
+        "          [--render file.wav]\n", exe);
+    std::exit(1);
+}
+
+Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        const std::string a = argv[i];
+        auto next = [&]() -> std::string { if (i + 1 >= argc) usage(argv[0]); return argv[++i]; };
+        if      (a == "--rates")     { o.rates.clear();  for (auto& s : splitList(next())) o.rates.push_back(std::atof(s.c_str())); }
+        else if (a == "--blocks")    { o.blocks.clear(); for (auto& s : splitList(next())) o.blocks.push_back(std::atoi(s.c_str())); }
+        else if (a == "--signals")   { o.signals = splitList(next()); }
+        else if (a == "--seconds")   { o.seconds   = std::atof(next().c_str()); }
+        else if (a == "--warmup")    { o.warmup    = std::atof(next().c_str()); }
+        else if (a == "--instances") { o.instances = std::max(1, std::atoi(next().c_str())); }
+        else if (a == "--channels")  { o.channels  = std::max(1, std::atoi(next().c_str())); }
+        else if (a == "--counters")  { o.counters  = true; }
+        else if (a == "--out")       { o.out = next(); }
+        else if (a == "--render")    { o.render = next(); }
+        else if (a == "--state")     { o.state  = next(); }
+        else if (a == "--param") {
+            const std::string kv = next();
+            const size_t eq = kv.find('=');
+            if (eq == std::string::npos) usage(argv[0]);
+            o.params.emplace_back(kv.substr(0, eq), (float)std::atof(kv.substr(eq + 1).c_str()));
+        }
+        else usage(argv[0]);
+    }
+    for (int b : o.blocks) if (b < 1) usage(argv[0]);
+    for (auto& s : o.signals)
+        if (s != "silence" && s != "noise" && s != "sine" && s != "sweep") usage(argv[0]);
+    return o;
+}
+
+// ── Parameters ──────────────────────────────────────────────────────────
+juce::RangedAudioParameter* findParam(juce::AudioProcessor& p, const std::string& id) {
+    for (auto* param : p.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param))
+            if (ranged->getParameterID().toStdString() == id)
+                return ranged;
+    return nullptr;
+}
+
+void applyParams(juce::AudioProcessor& p, const Options& o) {
+    for (auto* param : p.getParameters())
+        param->setValueNotifyingHost(param->getDefaultValue());
+    if (!o.state.empty()) {
+        const auto xml = juce::parseXML(juce::File::getCurrentWorkingDirectory().getChildFile(o.state));
+        if (xml == nullptr) {
+            std::fprintf(stderr, "cannot read state '%s'\n", o.state.c_str());
+            std::exit(1);
+        }
+        juce::MemoryBlock block;
+        juce::AudioProcessor::copyXmlToBinary(*xml, block);
+        p.setStateInformation(block.getData(), (int)block.getSize());
+    }
+    for (auto& [id, value] : o.params) {
+        auto* ranged = findParam(p, id);
+        if (ranged == nullptr) {
+            std::fprintf(stderr, "unknown parameter '%s'\n", id.c_str());
+            std::exit(1);
+        }
+        ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+    }
+}
+
+// Triangle sweep of every continuous parameter the user did not pin,
+// one full up/down cycle per second of audio.
+void sweepParams(juce::AudioProcessor& p, const Options& o, double t) {
+    const float v = (float)std::abs(2.0 * (t - std::floor(t)) - 1.0);
+    for (auto* param : p.getParameters()) {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param);
+        if (ranged == nullptr || param->isDiscrete()) continue;
+        const auto id = ranged->getParameterID().toStdString();
+        const bool pinned = std::any_of(o.params.begin(), o.params.end(),
+                                        [&](auto& kv) { return kv.first == id; });
+        if (!pinned) param->setValueNotifyingHost(v);
+    }
+}
+
+// ── Signals ─────────────────────────────────────────────────────────────
+struct SignalGen {
+    std::string kind;
+    double sr = 44100.0;
+    double phase[3] = {};
+    std::mt19937 rng { 0x5C0DE };
+    std::uniform_real_distribution<float> dist { -0.5f, 0.5f };
+
+    void fill(juce::AudioBuffer<float>& b, int n) {
+        if (kind == "silence") { b.clear(); return; }
+        if (kind == "sine") {
+            // 110 / 440 / 3520 Hz at -16 dBFS each, same on every channel
+            static constexpr double freqs[3] = { 110.0, 440.0, 3520.0 };
+            for (int i = 0; i < n; i++) {
+                float s = 0.f;
+                for (int k = 0; k < 3; k++) {
+                    s += 0.16f * (float)std::sin(juce::MathConstants<double>::twoPi * phase[k]);
+                    phase[k] += freqs[k] / sr;
+                    phase[k] -= std::floor(phase[k]);
+                }
+                for (int c = 0; c < b.getNumChannels(); c++) b.getWritePointer(c)[i] = s;
+            }
+            return;
+        }
+        // noise (and sweep, which feeds noise while the parameters move)
+        for (int c = 0; c < b.getNumChannels(); c++) {
+            auto* d = b.getWritePointer(c);
+            for (int i = 0; i < n; i++) d[i] = dist(rng);
+        }
+    }
+};
+
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    const size_t k = std::min(v.size() - 1, (size_t)std::floor(p * (double)(v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + (long)k, v.end());
+    return v[k];
+}
+
+// ── One measurement ─────────────────────────────────────────────────────
+RunResult runOne(const Options& o, double sr, int blockSize, const std::string& signal) {
+    std::vector<std::unique_ptr<juce::AudioProcessor>> procs;
+    for (int k = 0; k < o.instances; k++) {
+        procs.emplace_back(createPluginFilter());
+        auto& p = *procs.back();
+        p.setPlayConfigDetails(o.channels, o.channels, sr, blockSize);
+        p.setRateAndBufferSizeDetails(sr, blockSize);
+        applyParams(p, o);
+        p.prepareToPlay(sr, blockSize);
+    }
+
+    juce::AudioBuffer<float> buffer(o.channels, blockSize);
+    juce::MidiBuffer midi;
+    SignalGen gen;
+    gen.kind = signal;
+    gen.sr   = sr;
+    const bool sweep = signal == "sweep";
+
+    auto processAll = [&](double t) {
+        for (auto& p : procs) {
+            if (sweep) sweepParams(*p, o, t);
+            gen.fill(buffer, blockSize);
+            p->processBlock(buffer, midi);
+        }
+    };
+
+    const long warmBlocks = std::max(1L, (long)(o.warmup  * sr / blockSize));
+    const long numBlocks  = std::max(1L, (long)(o.seconds * sr / blockSize));
+    for (long b = 0; b < warmBlocks; b++) processAll((double)(b * blockSize) / sr);
+
+    std::vector<double> blockNs;
+    blockNs.reserve((size_t)(numBlocks * o.instances));
+
+    PerfCounters perf;
+    const bool counting = o.counters && perf.isAvailable();
+    if (counting) perf.start();
+
+    double totalNs = 0.0;
+    for (long b = 0; b < numBlocks; b++) {
+        const double t = (double)((warmBlocks + b) * blockSize) / sr;
+        for (auto& p : procs) {
+            if (sweep) sweepParams(*p, o, t);
+            gen.fill(buffer, blockSize);
+            const auto t0 = Clock::now();
+            p->processBlock(buffer, midi);
+            const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+            blockNs.push_back(ns);
+            totalNs += ns;
+        }
+    }
+
+    RunResult r;
+    r.sampleRate = sr;
+    r.blockSize  = blockSize;
+    r.signal     = signal;
+    if (counting) { r.counters = perf.stop(); r.hasCounters = true; }
+
+    const double samples = (double)numBlocks * blockSize * o.instances;
+    r.nsPerSample    = totalNs / samples;
+    r.realtimeFactor = (1.0e9 / sr) / r.nsPerSample;
+    r.p50  = percentile(blockNs, 0.50);
+    r.p99  = percentile(blockNs, 0.99);
+    r.p999 = percentile(blockNs, 0.999);
+    r.maxNs = blockNs.empty() ? 0.0 : *std::max_element(blockNs.begin(), blockNs.end());
+    return r;
+}
+
+// ── Render ──────────────────────────────────────────────────────────────
+bool renderToWav(const Options& o) {
+    const double sr = o.rates.front();
+    const int blockSize = o.blocks.front();
+    std::unique_ptr<juce::AudioProcessor> p(createPluginFilter());
+    p->setPlayConfigDetails(o.channels, o.channels, sr, blockSize);
+    p->setRateAndBufferSizeDetails(sr, blockSize);
+    applyParams(*p, o);
+    p->prepareToPlay(sr, blockSize);
+
+    const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(o.render);
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+    if (stream == nullptr) return false;
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sr, (unsigned)o.channels, 32, {}, 0));
+    if (writer == nullptr) return false;
+    stream.release();   // the writer owns it now
+
+    juce::AudioBuffer<float> buffer(o.channels, blockSize);
+    juce::MidiBuffer midi;
+    SignalGen gen;
+    gen.kind = o.signals.front();
+    gen.sr   = sr;
+    const long numBlocks = std::max(1L, (long)(o.seconds * sr / blockSize));
+    for (long b = 0; b < numBlocks; b++) {
+        if (gen.kind == "sweep") sweepParams(*p, o, (double)(b * blockSize) / sr);
+        gen.fill(buffer, blockSize);
+        p->processBlock(buffer, midi);
+        writer->writeFromAudioSampleBuffer(buffer, 0, blockSize);
+    }
+    return true;
+}
+
+// ── Report ──────────────────────────────────────────────────────────────
+void writeJson(std::FILE* f, const Options& o, const std::vector<RunResult>& runs) {
+    std::fprintf(f, "{\n  \"processor\": \"%s\",\n", SC_BENCH_PLUGIN_NAME);
+    std::fprintf(f, "  \"seconds\": %g,\n  \"instances\": %d,\n  \"channels\": %d,\n",
+                 o.seconds, o.instances, o.channels);
+    std::fprintf(f, "  \"params\": {");
+    for (size_t i = 0; i < o.params.size(); i++)
+        std::fprintf(f, "%s\"%s\": %g", i ? ", " : "", o.params[i].first.c_str(), (double)o.params[i].second);
+    std::fprintf(f, "},\n  \"runs\": [\n");
+    for (size_t i = 0; i < runs.size(); i++) {
+        const auto& r = runs[i];
+        std::fprintf(f, "    { \"sampleRate\": %g, \"blockSize\": %d, \"signal\": \"%s\", "
+                        "\"nsPerSample\": %.3f, \"realtimeFactor\": %.2f, "
+                        "\"blockNs\": { \"p50\": %.0f, \"p99\": %.0f, \"p99_9\": %.0f, \"max\": %.0f }, ",
+                     r.sampleRate, r.blockSize, r.signal.c_str(), r.nsPerSample, r.realtimeFactor,
+                     r.p50, r.p99, r.p999, r.maxNs);
+        if (r.hasCounters)
+            std::fprintf(f, "\"counters\": { \"cycles\": %llu, \"instructions\": %llu, \"ipc\": %.3f, "
+                            "\"cacheReferences\": %llu, \"cacheMisses\": %llu, \"cacheMissRate\": %.4f, "
+                            "\"branchMisses\": %llu } }",
+                         (unsigned long long)r.counters.cycles, (unsigned long long)r.counters.instructions,
+                         r.counters.ipc(), (unsigned long long)r.counters.cacheRefs,
+                         (unsigned long long)r.counters.cacheMisses, r.counters.cacheMissRate(),
+                         (unsigned long long)r.counters.branchMisses);
+        else
+            std::fprintf(f, "\"counters\": null }");
+        std::fprintf(f, "%s\n", i + 1 < runs.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // APVTS wants a message manager around, even though no editor is made
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    const Options o = parseArgs(argc, argv);
+
+    if (o.counters && !PerfCounters().isAvailable())
+        std::fprintf(stderr, "note: hardware counters unavailable, reporting timings only\n");
+
+    if (!o.render.empty()) {
+        if (renderToWav(o)) return 0;
+        std::fprintf(stderr, "cannot write %s\n", o.render.c_str());
+        return 1;
+    }
+
+    std::vector<RunResult> runs;
+    for (double sr : o.rates)
+        for (int bs : o.blocks)
+            for (auto& sig : o.signals) {
+                runs.push_back(runOne(o, sr, bs, sig));
+                const auto& r = runs.back();
+                std::fprintf(stderr, "%-9s %6.0f Hz  block %4d  %-7s  %7.2f ns/sample  x%.0f realtime\n",
+                             SC_BENCH_PLUGIN_NAME, sr, bs, sig.c_str(), r.nsPerSample, r.realtimeFactor);
+            }
+
+    std::FILE* f = o.out.empty() ? stdout : std::fopen(o.out.c_str(), "w");
+    if (f == nullptr) { std::fprintf(stderr, "cannot open %s\n", o.out.c_str()); return 1; }
+    writeJson(f, o, runs);
+    if (f != stdout) std::fclose(f);
+    return 0;
+}
@@ -0,0 +1,423 @@
+// Accuracy and speed check for the shared DSP kernels (Plugins/Shared).
+//
+// Accuracy: dense sweep of each fast kernel against double-precision libm,
+// compared with the error bound the header documents. Speed: the same
+// 4096-value arrays run through std:: and sc:: versions.
+//
+// Curve tables: tanh tabulated at each SHAPER LUT density, against the
+// step^2 / 8 * max|f''| interpolation bound CurveTable.h documents.
+//
+// Oversampler: passband flatness and image / alias rejection of every
+// factor and filter type, measured with sines up to 0.45 fs.
+//
+// Delay interpolators: every FractionalDelay kernel read at fixed delays
+// with fractions 0 .. 0.9, sines up to 0.45 fs through it. Magnitude and
+// phase-delay error against the ideal delay, compared with the bounds
+// Interpolators.h documents, and ns per read for fixed and moving delays.
+//
+// Delay storage: an ECHODLY-style feedback loop run with each SampleStore.h
+// format against float32. Noise it adds, in dBFS and below the signal, held
+// to the floors the header documents, and ns per read as above.
+//
+// Prints JSON to stdout; exits non-zero if any kernel exceeds its bound.
+
+#include "CurveTable.h"
+#include "FastMath.h"
+#include "FractionalDelay.h"
+#include "Oversampler.h"
+#include <chrono>
+#include <complex>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Accuracy {
+    std::string name;
+    double maxErr = 0.0, bound = 0.0;
+    bool relative = false;
+    bool ok() const { return maxErr <= bound; }
+};
+
+struct Speed {
+    std::string name;
+    double stdNs = 0.0, fastNs = 0.0;
+};
+
+Accuracy sweep(const std::string& name, double lo, double hi, double step, bool relative, double bound,
+               const std::function<float(float)>& fast, const std::function<double(double)>& ref) {
+    Accuracy a { name, 0.0, bound, relative };
+    for (double v = lo; v <= hi; v += step) {
+        const float  x = (float)v;
+        const double r = ref((double)x);
+        const double e = std::abs((double)fast(x) - r);
+        a.maxErr = std::max(a.maxErr, relative ? e / std::abs(r) : e);
+    }
+    return a;
+}
+
+template <typename F>
+double timeKernel(F&& f, const std::vector<float>& in, std::vector<float>& out) {
+    constexpr int reps = 2000;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        for (size_t i = 0; i < in.size(); i++) out[i] = f(in[i]);
+        // keep the optimiser from hoisting the loop out of the repetitions
+        asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - t0).count();
+    return ns / (double)(reps * in.size());
+}
+
+template <typename S, typename F>
+Speed race(const std::string& name, float lo, float hi, S&& stdFn, F&& fastFn) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(lo, hi);
+    std::vector<float> in(4096), out(4096);
+    for (auto& v : in) v = dist(rng);
+    Speed s { name };
+    s.stdNs  = timeKernel(stdFn,  in, out);
+    s.fastNs = timeKernel(fastFn, in, out);
+    return s;
+}
+
+struct Rejection {
+    std::string name;
+    double passDevDb = 0.0, imageDb = -999.0, aliasDb = -999.0;
+    bool ok() const { return passDevDb <= 0.01 && imageDb <= -85.0 && aliasDb <= -85.0; }
+};
+
+// Amplitude of the sinusoid at f (cycles per sample) over y[from, to).
+// Blackman-Harris window, so leakage from off-bin tones stays below -92 dB.
+double toneAmp(const std::vector<float>& y, double f, size_t from, size_t to) {
+    const double twoPi = 6.283185307179586, len = (double)(to - from);
+    std::complex<double> acc = 0.0;
+    double wsum = 0.0;
+    for (size_t i = from; i < to; i++) {
+        const double t = twoPi * (double)(i - from) / len;
+        const double w = 0.35875 - 0.48829 * std::cos(t) + 0.14128 * std::cos(2 * t) - 0.01168 * std::cos(3 * t);
+        acc  += w * (double)y[i] * std::polar(1.0, -twoPi * f * (double)i);
+        wsum += w;
+    }
+    return std::abs(acc) * 2.0 / wsum;
+}
+
+Rejection measureOversampler(int stages, sc::Oversampler::Filter filter) {
+    constexpr int block = 128, blocks = 96, n = block * blocks;
+    sc::Oversampler os;
+    os.prepare(1, block);
+    os.setMode(stages, filter);
+    const int factor = os.factor();
+
+    Rejection r;
+    r.name = std::to_string(factor) + "x " + (filter == sc::Oversampler::Filter::linearPhaseFIR ? "fir" : "iir");
+
+    // Base-rate sine through up() and straight back down(): passband level,
+    // and image energy at the top rate.
+    for (double f : { 0.01, 0.1, 0.2, 0.3, 0.4, 0.45 }) {
+        os.reset();
+        std::vector<float> in((size_t)n), hi((size_t)(n * factor)), out((size_t)n);
+        for (int i = 0; i < n; i++) in[(size_t)i] = (float)std::sin(6.283185307179586 * f * i);
+        for (int b = 0; b < n; b += block) {
+            const float* h = os.up(0, &in[(size_t)b], block);
+            std::copy(h, h + block * factor, &hi[(size_t)(b * factor)]);
+            os.down(0, &out[(size_t)b], block);
+        }
+        const size_t hiFrom = hi.size() / 2;
+        const double sig = toneAmp(hi, f / factor, hiFrom, hi.size());
+        for (int k = 1; k < factor; k++)
+            for (double img : { (k - f) / factor, (k + f) / factor })
+                if (img < 0.5)
+                    r.imageDb = std::max(r.imageDb, 20.0 * std::log10(toneAmp(hi, img, hiFrom, hi.size()) / sig + 1e-30));
+        r.passDevDb = std::max(r.passDevDb, std::abs(20.0 * std::log10(toneAmp(out, f, (size_t)n / 2, (size_t)n))));
+    }
+
+    // Top-rate sines above the base Nyquist through down(): whatever folds
+    // into the passband is aliasing.
+    std::vector<float> zeros((size_t)block), out((size_t)n);
+    for (double fh = 0.55 / factor; fh < 0.5; fh += 0.013) {
+        double fa = fh * factor - std::floor(fh * factor);
+        if (fa > 0.5) fa = 1.0 - fa;
+        if (fa > 0.45) continue;
+        os.reset();
+        for (int b = 0; b < n; b += block) {
+            float* h = os.up(0, zeros.data(), block);
+            for (int j = 0; j < block * factor; j++)
+                h[j] = (float)std::sin(6.283185307179586 * fh * (double)(b * factor + j));
+            os.down(0, &out[(size_t)b], block);
+        }
+        r.aliasDb = std::max(r.aliasDb, 20.0 * std::log10(toneAmp(out, fa, (size_t)n / 2, (size_t)n) + 1e-30));
+    }
+    return r;
+}
+
+struct DelayResponse {
+    std::string name;
+    double passDevDb = 0.0, upperDevDb = 0.0, delayErr = 0.0, bound = 0.0, delayBound = 0.0;
+    double fixedNs = 0.0, movingNs = 0.0;
+    bool ok() const { return passDevDb <= bound && delayErr <= delayBound; }
+};
+
+// Complex amplitude of the sinusoid at f over y[from, to), as toneAmp()
+std::complex<double> tone(const std::vector<float>& y, double f, size_t from, size_t to) {
+    const double twoPi = 6.283185307179586, len = (double)(to - from);
+    std::complex<double> acc = 0.0;
+    double wsum = 0.0;
+    for (size_t i = from; i < to; i++) {
+        const double t = twoPi * (double)(i - from) / len;
+        const double w = 0.35875 - 0.48829 * std::cos(t) + 0.14128 * std::cos(2 * t) - 0.01168 * std::cos(3 * t);
+        acc  += w * (double)y[i] * std::polar(1.0, -twoPi * f * (double)i);
+        wsum += w;
+    }
+    return acc * 2.0 / wsum;
+}
+
+template <class K>
+DelayResponse measureDelay(const std::string& name) {
+    constexpr int block = 128, blocks = 64, n = block * blocks, size = 1024;
+    constexpr double whole = 300.0;   // past one block, so every block can be read ahead
+    DelayResponse r { name };
+    r.bound = K::kPassDevDb; r.delayBound = K::kDelayError;
+
+    std::vector<float> in((size_t)n), out((size_t)n);
+    for (int k = 0; k < 10; k++) {
+        const double d = whole + k * 0.1;
+        for (double f = 0.01; f < 0.401; f += 0.01) {
+            for (int i = 0; i < n; i++) in[(size_t)i] = (float)std::sin(6.283185307179586 * f * i);
+            sc::FractionalDelay line;
+            line.init(size);
+            typename K::State st;
+            for (int b = 0; b < n; b += block) {
+                line.template read<K>((float)d, &out[(size_t)b], block, st);
+                for (int i = 0; i < block; i++) line.push(in[(size_t)(b + i)]);
+            }
+            // The response relative to the input tone, with the ideal delay taken out
+            const auto h = tone(out, f, (size_t)n / 2, (size_t)n) / tone(in, f, (size_t)n / 2, (size_t)n)
+                         * std::polar(1.0, 6.283185307179586 * f * d);
+            const double devDb = std::abs(20.0 * std::log10(std::abs(h)));
+            if (f <= 0.25) {
+                r.passDevDb = std::max(r.passDevDb, devDb);
+                r.delayErr  = std::max(r.delayErr, std::abs(std::arg(h) / (6.283185307179586 * f)));
+            }
+            r.upperDevDb = std::max(r.upperDevDb, devDb);
+        }
+    }
+
+    // Speed: a 512-sample line read a block at a time, at a fixed delay and
+    // at a delay that moves every sample
+    sc::FractionalDelay line;
+    line.init(4096);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int i = 0; i < 4096; i++) line.push(dist(rng));
+    float delays[block];
+    for (int i = 0; i < block; i++) delays[i] = 1000.0f + 8.0f * (float)std::sin(0.05 * i);
+    constexpr int reps = 20000;
+    typename K::State st;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        line.template read<K>(1000.3f + (float)(k & 7), out.data(), block, st);
+        asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        line.template read<K>(delays, out.data(), block, st);
+        asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    r.fixedNs  = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (reps * block);
+    r.movingNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (reps * block);
+    return r;
+}
+
+struct StorageNoise {
+    std::string name;
+    int    bytes = 0;
+    double noiseDbfs = 0.0, belowSignalDb = 0.0, bound = 0.0;
+    bool   relative = false;   // bound is on belowSignalDb, else on noiseDbfs
+    double fixedNs = 0.0, movingNs = 0.0;
+    bool ok() const { return (relative ? belowSignalDb : noiseDbfs) <= bound; }
+};
+
+// One second of -12 dBFS noise into a 100 ms line (at 48 kHz) that feeds
+// back at 0.88, ECHODLY's ceiling, through its hi-cut; then three seconds
+// of tail. The stored format re-rounds the signal on every pass round the
+// loop, so this is the worst the feedback path makes of it.
+template <class Store>
+std::vector<float> runEchoLoop() {
+    constexpr int sr = 48000, n = sr * 4;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 0.25f);
+    sc::BasicFractionalDelay<Store> line;
+    line.init(sr);
+    std::vector<float> out((size_t)n);
+    float lp = 0.0f;
+    for (int i = 0; i < n; i++) {
+        const float x = i < sr ? noise(rng) : 0.0f;
+        const float y = line.read(4800.37f);
+        lp = lp * 0.6f + y * 0.4f;
+        line.push(x + 0.88f * lp);
+        out[(size_t)i] = y;
+    }
+    return out;
+}
+
+template <class Store>
+StorageNoise measureStorage(const std::string& name, double bound, bool relative) {
+    StorageNoise r { name, (int)sizeof(typename Store::Word) };
+    r.bound = bound; r.relative = relative;
+    const auto ref = runEchoLoop<sc::store::Float32>(), got = runEchoLoop<Store>();
+    double err = 0.0, sig = 0.0;
+    for (size_t i = 0; i < ref.size(); i++) {
+        err += ((double)got[i] - ref[i]) * ((double)got[i] - ref[i]);
+        sig += (double)ref[i] * ref[i];
+    }
+    r.noiseDbfs     = 10.0 * std::log10(err / (double)ref.size() + 1e-30);
+    r.belowSignalDb = 10.0 * std::log10(err / sig + 1e-30);
+
+    // Speed: Hermite block reads, fixed and moving, as measureDelay()
+    constexpr int block = 128, reps = 20000;
+    sc::BasicFractionalDelay<Store> line;
+    line.init(4096);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int i = 0; i < 4096; i++) line.push(dist(rng));
+    float delays[block], out[block];
+    for (int i = 0; i < block; i++) delays[i] = 1000.0f + 8.0f * (float)std::sin(0.05 * i);
+    sc::interp::Hermite::State st;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        line.read(1000.3f + (float)(k & 7), out, block, st);
+        asm volatile("" : : "r"(out) : "memory");
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; k++) {
+        line.read(delays, out, block, st);
+        asm volatile("" : : "r"(out) : "memory");
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    r.fixedNs  = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (reps * block);
+    r.movingNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (reps * block);
+    return r;
+}
+
+} // namespace
+
+int main() {
+    const double twoPi = 6.283185307179586476925;
+
+    std::vector<Accuracy> acc;
+    acc.push_back(sweep("exp",   -87.0,  88.0, 1.0e-4, true, sc::kExpMaxRelError,
+                        [](float x) { return sc::fastExp(x); },  [](double x) { return std::exp(x); }));
+    acc.push_back(sweep("exp2", -126.0, 127.0, 1.0e-4, true, sc::kExp2MaxRelError,
+                        [](float x) { return sc::fastExp2(x); }, [](double x) { return std::exp2(x); }));
+    acc.push_back(sweep("pow80",   0.0,   1.0, 1.0e-6, true, sc::kPowMaxRelError,
+                        [](float x) { return sc::fastPow(sc::kLog2Of80, x); }, [](double x) { return std::pow(80.0, x); }));
+    acc.push_back(sweep("pow1500", 0.0,   1.0, 1.0e-6, true, sc::kPowMaxRelError,
+                        [](float x) { return sc::fastPow(sc::kLog2Of1500, x); }, [](double x) { return std::pow(1500.0, x); }));
+    acc.push_back(sweep("pow10",  -0.6,   0.6, 1.0e-6, true, sc::kPowMaxRelError,
+                        [](float x) { return sc::fastPow(sc::kLog2Of10, x); }, [](double x) { return std::pow(10.0, x); }));
+    acc.push_back(sweep("tanh",  -20.0,  20.0, 1.0e-5, false, sc::kTanhMaxAbsError,
+                        [](float x) { return sc::fastTanh(x); }, [](double x) { return std::tanh(x); }));
+    acc.push_back(sweep("sin2pi", -4.0,   4.0, 1.0e-6, false, sc::kSin2PiMaxAbsError,
+                        [](float x) { return sc::fastSin2Pi(x); },
+                        [&](double x) { return std::sin(twoPi * (x - std::floor(x))); }));
+    acc.push_back(sweep("sin2pi_far", 65000.0, 65535.0, 1.0e-3, false, sc::kSin2PiMaxAbsError,
+                        [](float x) { return sc::fastSin2Pi(x); },
+                        [&](double x) { return std::sin(twoPi * (x - std::floor(x))); }));
+    acc.push_back(sweep("cos2pi", -4.0,   4.0, 1.0e-6, false, sc::kSin2PiMaxAbsError,
+                        [](float x) { return sc::fastCos2Pi(x); },
+                        [&](double x) { return std::cos(twoPi * (x - std::floor(x))); }));
+
+    // max|tanh''| = 4 / (3 sqrt 3); 2.5e-7 covers the float rounding
+    std::vector<sc::CurveTable> tanhTables(3);
+    for (int k = 0; k < 3; k++) {
+        const int density = 64 << (2 * k);
+        tanhTables[(size_t)k].build([](double u) { return std::tanh(u); }, 0.0, 8.0, density);
+        const double step = 1.0 / density;
+        const auto& t = tanhTables[(size_t)k];
+        acc.push_back(sweep("tanhTable" + std::to_string(density), -20.0, 20.0, 1.0e-5, false,
+                            step * step / 8.0 * 0.7698 + 2.5e-7,
+                            [&](float x) { return std::copysign(t(std::abs(x)), x); },
+                            [](double x) { return std::tanh(x); }));
+    }
+
+    std::vector<Speed> speed;
+    speed.push_back(race("exp",    -10.f, 10.f, [](float x) { return std::exp(x); },  [](float x) { return sc::fastExp(x); }));
+    speed.push_back(race("pow80",    0.f,  1.f, [](float x) { return std::pow(80.0f, x); },
+                                                [](float x) { return sc::fastPow(sc::kLog2Of80, x); }));
+    speed.push_back(race("tanh",    -8.f,  8.f, [](float x) { return std::tanh(x); }, [](float x) { return sc::fastTanh(x); }));
+    speed.push_back(race("tanhTable256", -8.f, 8.f, [](float x) { return std::tanh(x); },
+                         [&](float x) { return std::copysign(tanhTables[1](std::abs(x)), x); }));
+    speed.push_back(race("sin2pi",   0.f,  1.f, [](float x) { return std::sin(6.28318530718f * x); },
+                                                [](float x) { return sc::fastSin2Pi(x); }));
+    speed.push_back(race("fmod1",    0.f,  4.f, [](float x) { return std::fmod(x, 1.0f); },
+                                                [](float x) { return sc::wrapPhase(x, 1.0f); }));
+
+    std::vector<Rejection> rej;
+    for (auto filter : { sc::Oversampler::Filter::minPhaseIIR, sc::Oversampler::Filter::linearPhaseFIR })
+        for (int stages = 1; stages <= sc::Oversampler::kMaxStages; stages++)
+            rej.push_back(measureOversampler(stages, filter));
+
+    sc::interp::prepareSincTable();
+    std::vector<DelayResponse> delay;
+    delay.push_back(measureDelay<sc::interp::Linear>("linear"));
+    delay.push_back(measureDelay<sc::interp::Hermite>("hermite"));
+    delay.push_back(measureDelay<sc::interp::Lagrange>("lagrange"));
+    delay.push_back(measureDelay<sc::interp::Allpass>("allpass"));
+    delay.push_back(measureDelay<sc::interp::Sinc8>("sinc8"));
+
+    std::vector<StorageNoise> storage;
+    storage.push_back(measureStorage<sc::store::Float32>("float32", -200.0, true));
+    storage.push_back(measureStorage<sc::store::Half>("half", -70.0, true));
+    storage.push_back(measureStorage<sc::store::Int16>("int16", -85.0, false));
+
+    bool allOk = true;
+    std::printf("{\n  \"accuracy\": [\n");
+    for (size_t i = 0; i < acc.size(); i++) {
+        const auto& a = acc[i];
+        allOk = allOk && a.ok();
+        std::printf("    { \"kernel\": \"%s\", \"%s\": %.3g, \"bound\": %.3g, \"ok\": %s }%s\n",
+                    a.name.c_str(), a.relative ? "maxRelError" : "maxAbsError", a.maxErr, a.bound,
+                    a.ok() ? "true" : "false", i + 1 < acc.size() ? "," : "");
+    }
+    std::printf("  ],\n  \"speed\": [\n");
+    for (size_t i = 0; i < speed.size(); i++) {
+        const auto& s = speed[i];
+        std::printf("    { \"kernel\": \"%s\", \"stdNs\": %.3f, \"fastNs\": %.3f, \"speedup\": %.1f }%s\n",
+                    s.name.c_str(), s.stdNs, s.fastNs, s.stdNs / s.fastNs, i + 1 < speed.size() ? "," : "");
+    }
+    std::printf("  ],\n  \"oversampler\": [\n");
+    for (size_t i = 0; i < rej.size(); i++) {
+        const auto& r = rej[i];
+        allOk = allOk && r.ok();
+        std::printf("    { \"mode\": \"%s\", \"passbandDevDb\": %.4f, \"imageDb\": %.1f, \"aliasDb\": %.1f, \"ok\": %s }%s\n",
+                    r.name.c_str(), r.passDevDb, r.imageDb, r.aliasDb, r.ok() ? "true" : "false",
+                    i + 1 < rej.size() ? "," : "");
+    }
+    std::printf("  ],\n  \"delay\": [\n");
+    for (size_t i = 0; i < delay.size(); i++) {
+        const auto& d = delay[i];
+        allOk = allOk && d.ok();
+        std::printf("    { \"kernel\": \"%s\", \"passbandDevDb\": %.3f, \"bound\": %.3f, \"upperDevDb\": %.2f, "
+                    "\"delayError\": %.4f, \"delayBound\": %.4f, \"fixedNs\": %.2f, \"movingNs\": %.2f, \"ok\": %s }%s\n",
+                    d.name.c_str(), d.passDevDb, d.bound, d.upperDevDb, d.delayErr, d.delayBound, d.fixedNs, d.movingNs,
+                    d.ok() ? "true" : "false", i + 1 < delay.size() ? "," : "");
+    }
+    std::printf("  ],\n  \"storage\": [\n");
+    for (size_t i = 0; i < storage.size(); i++) {
+        const auto& s = storage[i];
+        allOk = allOk && s.ok();
+        std::printf("    { \"format\": \"%s\", \"bytes\": %d, \"noiseDbfs\": %.1f, \"belowSignalDb\": %.1f, "
+                    "\"%s\": %.1f, \"fixedNs\": %.2f, \"movingNs\": %.2f, \"ok\": %s }%s\n",
+                    s.name.c_str(), s.bytes, s.noiseDbfs, s.belowSignalDb, s.relative ? "belowSignalBound" : "noiseBound",
+                    s.bound, s.fixedNs, s.movingNs, s.ok() ? "true" : "false", i + 1 < storage.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+    return allOk ? 0 : 1;
+}
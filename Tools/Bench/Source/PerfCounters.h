@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+
+#if defined(__linux__)
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #include <cstring>
+#endif
+
+// Optional hardware counters for the bench harness.
+// Linux only — opens one perf_event group (cycles leader + instructions,
+// cache refs/misses, branch misses) on the calling thread. Anywhere else,
+// or when perf_event_paranoid forbids it, isAvailable() is false and the
+// harness just leaves the counters out of the report.
+class PerfCounters {
+public:
+    struct Sample {
+        uint64_t cycles = 0, instructions = 0;
+        uint64_t cacheRefs = 0, cacheMisses = 0, branchMisses = 0;
+        double ipc() const { return cycles ? (double)instructions / (double)cycles : 0.0; }
+        double cacheMissRate() const { return cacheRefs ? (double)cacheMisses / (double)cacheRefs : 0.0; }
+    };
+
+    PerfCounters() {
+#if defined(__linux__)
+        const uint64_t configs[NUM] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES };
+        for (int i = 0; i < NUM; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size           = sizeof(attr);
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.config         = configs[i];
+            attr.disabled       = i == 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP;
+            fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+            if (fds[i] < 0) { close(); return; }
+        }
+        available = true;
+#endif
+    }
+    ~PerfCounters() { close(); }
+
+    bool isAvailable() const { return available; }
+
+    void start() {
+#if defined(__linux__)
+        if (!available) return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    Sample stop() {
+        Sample s;
+#if defined(__linux__)
+        if (!available) return s;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t data[1 + NUM] = {};
+        if (read(fds[0], data, sizeof(data)) != (ssize_t)sizeof(data)) return s;
+        s.cycles       = data[1];
+        s.instructions = data[2];
+        s.cacheRefs    = data[3];
+        s.cacheMisses  = data[4];
+        s.branchMisses = data[5];
+#endif
+        return s;
+    }
+
+private:
+    static constexpr int NUM = 5;
+    int fds[NUM] = { -1, -1, -1, -1, -1 };
+    bool available = false;
+
+    void close() {
+#if defined(__linux__)
+        for (int i = NUM - 1; i >= 0; i--)
+            if (fds[i] >= 0) { ::close(fds[i]); fds[i] = -1; }
+#endif
+        available = false;
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+};